@@ -0,0 +1,41 @@
+/*
+ * IEEE 802.15.4 Channel Scan Example for ESP32
+ *
+ * This sketch measures the energy on all channels before starting the
+ * transceiver on the quietest one.
+ *
+ * Features:
+ * - Scans the channels 11 to 26 with the energy detection of the radio
+ * - Prints the channels ranked from the quietest to the noisiest
+ * - Starts the transceiver on the quietest channel
+ */
+#include "ChannelScanner.h"
+#include "ESP32TransceiverIEEE802_15_4.h"
+
+Address local({0xAB, 0xCD});
+ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234, local);
+ChannelScanner scanner;
+
+void setup() {
+  Serial.begin(115200);
+
+  // Spend 200 ms on each channel
+  scanner.setDwellTimeMs(200);
+  // Select the quietest channel in the transceiver
+  if (!scanner.scan(transceiver)) {
+    Serial.println("Channel scan failed");
+  }
+  for (const channel_energy_t& result : scanner.getResults()) {
+    Serial.printf("Channel %d: avg %d dBm, max %d dBm\n",
+                  static_cast<int>(result.channel), result.avgDbm(),
+                  result.max_dbm);
+  }
+
+  if (!transceiver.begin()) {
+    return;
+  }
+  Serial.printf("Using channel %d\n",
+                static_cast<int>(transceiver.getChannel()));
+}
+
+void loop() { delay(1000); }
@@ -0,0 +1,62 @@
+/*
+ * IEEE 802.15.4 Channel Hopping Sniffer Example for ESP32
+ *
+ * This sketch captures the IEEE 802.15.4 frames of several channels with a
+ * single ESP32 by hopping across the channels.
+ *
+ * Features:
+ * - Initializes the ESP32 transceiver in promiscuous mode
+ * - Stays 50 ms on each channel and up to 200 ms on busy channels
+ * - Logs the channel, sequence number and length of each received frame
+ * - Prints the frame rate of each channel and the hop duration every 10 s
+ */
+#include "ChannelHopper.h"
+#include "ESP32TransceiverIEEE802_15_4.h"
+
+#define TAG "IEEE802154_HOPPING_SNIFFER"
+
+Address local({0xAB, 0xCD});
+ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234, local);
+ChannelHopper hopper(transceiver);
+
+// Callback for received frames: the channel is provided in the frame info
+void rx_callback(Frame& frame, esp_ieee802154_frame_info_t& frame_info,
+                 void* user_data) {
+  ESP_LOGI(TAG, "channel: %d, seqNum: %02x, len: %d", frame_info.channel,
+           frame.sequenceNumber, frame.payloadLen);
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  transceiver.setRxCallback(rx_callback, NULL);
+  // Enable promiscuous mode to capture all frames
+  transceiver.setPromiscuousModeActive(true);
+  if (!transceiver.begin()) {
+    ESP_LOGE(TAG, "Failed to initialize transceiver");
+    return;
+  }
+
+  hopper.setChannels({channel_t::CHANNEL_11, channel_t::CHANNEL_15,
+                      channel_t::CHANNEL_20, channel_t::CHANNEL_25});
+  hopper.setDwellTimeMs(50);
+  hopper.setMaxDwellTimeMs(200);
+  if (!hopper.begin()) {
+    ESP_LOGE(TAG, "Failed to start channel hopping");
+  }
+}
+
+void loop() {
+  delay(10000);
+  for (int ch = 11; ch <= 26; ch++) {
+    channel_hop_stats_t stats =
+        hopper.getChannelStats(static_cast<channel_t>(ch));
+    if (stats.dwell_us == 0) continue;
+    Serial.printf("Channel %d: %u frames, %.1f frames/s\n", ch,
+                  (unsigned)stats.frames, stats.frameRate());
+  }
+  Serial.printf("Hops: %u, avg %u us, max %u us\n",
+                (unsigned)hopper.getHopCount(),
+                (unsigned)hopper.getHopTimeAvgUs(),
+                (unsigned)hopper.getHopTimeMaxUs());
+}
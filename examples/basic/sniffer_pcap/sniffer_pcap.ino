@@ -0,0 +1,53 @@
+/*
+ * IEEE 802.15.4 PCAPNG Sniffer Example for ESP32
+ *
+ * This sketch captures all IEEE 802.15.4 frames on channel 11 and writes them
+ * in pcapng format to the serial port, so that they can be analyzed with
+ * Wireshark.
+ *
+ * Features:
+ * - Initializes the ESP32 transceiver in promiscuous mode on channel 11
+ * - Stores the raw frames with RSSI, LQI, channel and timestamp without any
+ *   formatting
+ * - Drains the binary capture to Serial
+ *
+ * Usage:
+ * - Disable the logging (Core Debug Level: None), so that only the capture is
+ *   written to the serial port
+ * - Record the serial output to a file, e.g.
+ *   stty -F /dev/ttyUSB0 921600 raw && cat /dev/ttyUSB0 > capture.pcapng
+ * - Open capture.pcapng with Wireshark
+ */
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "PcapngWriter.h"
+
+Address local({0xAB, 0xCD});
+ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234, local);
+PcapngWriter capture(8 * 1024);
+
+void setup() {
+  Serial.begin(921600);
+
+  // Enable promiscuous mode to capture all frames
+  transceiver.setPromiscuousModeActive(true);
+  // We read the raw frames in the loop: no receive task and no parsing
+  transceiver.setReceiveTask(nullptr);
+  transceiver.setFramePoolSize(16);
+
+  if (!transceiver.begin()) {
+    return;
+  }
+  capture.begin();
+}
+
+void loop() {
+  // Add all received frames to the capture
+  frame_data_t* packet = transceiver.receiveFrame(pdMS_TO_TICKS(10));
+  while (packet != nullptr) {
+    capture.write(*packet);
+    transceiver.releaseFrame(packet);
+    packet = transceiver.receiveFrame(0);
+  }
+  // Write the capture to the serial port
+  capture.drain(Serial);
+}
@@ -23,6 +23,8 @@ void setup() {
   delay(3000);
 
   Serial.println("Starting...");
+  // receive the frames in the background while we process the data
+  stream.setRxTaskActive(true);
   stream.begin();
   startTime = millis();
 }
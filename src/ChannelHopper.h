@@ -0,0 +1,283 @@
+#pragma once
+
+#include <atomic>
+#include <initializer_list>
+#include <vector>
+
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "RadioDispatcher.h"
+#include "esp_ieee802154.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Statistics of a channel that is visited by the ChannelHopper.
+ */
+struct channel_hop_stats_t {
+  uint32_t frames = 0;    // Frames received on the channel
+  uint64_t dwell_us = 0;  // Total time spent on the channel
+
+  /// Received frames per second while listening on the channel
+  float frameRate() const {
+    return dwell_us == 0 ? 0.0f : frames * 1000000.0f / dwell_us;
+  }
+};
+
+/**
+ * @brief Sniffer mode that hops the radio across a list of channels, so that
+ * a single device can capture the traffic of several channels.
+ *
+ * The radio stays on each channel for the dwell time. With an adaptive dwell
+ * it stays longer on a busy channel: as long as frames have been received in
+ * the last dwell time, up to the maximum dwell time. The frames are delivered
+ * through the queue and callbacks of the transceiver as usual: use
+ * esp_ieee802154_frame_info_t::channel to tell the channels apart.
+ *
+ * A hop only calls esp_ieee802154_set_channel() and esp_ieee802154_receive(),
+ * which applies the new channel, from an esp_timer callback: the duration is
+ * measured and provided by getHopTimeAvgUs() and getHopTimeMaxUs(). A hop is
+ * postponed while a frame is being transmitted: the check and the hop are
+ * done with the TX lock of the RadioDispatcher, so that no transmission can
+ * start in between.
+ *
+ * Example:
+ * @code
+ * ChannelHopper hopper(transceiver);
+ * hopper.setChannels({channel_t::CHANNEL_11, channel_t::CHANNEL_15});
+ * hopper.setDwellTimeMs(50);
+ * transceiver.setPromiscuousModeActive(true);
+ * transceiver.begin();
+ * hopper.begin();
+ * @endcode
+ */
+class ChannelHopper {
+ public:
+  /// Hops over all channels from 11 to 26 by default
+  ChannelHopper(ESP32TransceiverIEEE802_15_4& transceiver)
+      : p_transceiver(&transceiver) {
+    for (int ch = 11; ch <= 26; ch++) {
+      channels.push_back(static_cast<channel_t>(ch));
+    }
+  }
+
+  ~ChannelHopper() {
+    end();
+    if (timer) esp_timer_delete(timer);
+  }
+
+  /// Defines the channels to visit: call before begin()
+  void setChannels(std::initializer_list<channel_t> list) {
+    channels.assign(list.begin(), list.end());
+  }
+
+  /// Defines the time in milliseconds that is spent on each channel
+  void setDwellTimeMs(uint32_t ms) { dwell_us = ms * 1000; }
+
+  /**
+   * @brief Stays on a busy channel for up to the indicated time: the dwell
+   * time is extended as long as frames have been received in the last dwell
+   * time. Use 0 to hop after each dwell time.
+   */
+  void setMaxDwellTimeMs(uint32_t ms) { max_dwell_us = ms * 1000; }
+
+  /**
+   * @brief Starts hopping on the first channel: the transceiver must have
+   * been started with begin().
+   */
+  bool begin() {
+    if (channels.empty() || dwell_us == 0) {
+      ESP_LOGE(TAG, "No channels or dwell time defined");
+      return false;
+    }
+    if (!p_transceiver->radio_enabled) {
+      ESP_LOGE(TAG, "The transceiver must be started before hopping");
+      return false;
+    }
+    if (timer == nullptr) {
+      esp_timer_create_args_t args = {};
+      args.callback = onTimer;
+      args.arg = this;
+      args.dispatch_method = ESP_TIMER_TASK;
+      args.name = "ChannelHopper";
+      if (esp_timer_create(&args, &timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create the hop timer");
+        return false;
+      }
+    }
+    end();
+    resetStatistics();
+    channel_idx = 0;
+    current_channel = p_transceiver->channel;
+    if (!hop(channels[0])) {
+      ESP_LOGE(TAG, "Cannot start hopping while transmitting");
+      return false;
+    }
+    p_transceiver->p_channel_hopper = this;
+    is_active = true;
+    return esp_timer_start_once(timer, dwell_us) == ESP_OK;
+  }
+
+  /// Stops hopping: the radio stays on the current channel
+  void end() {
+    if (!is_active) return;
+    is_active = false;
+    esp_timer_stop(timer);
+    p_transceiver->p_channel_hopper = nullptr;
+    portENTER_CRITICAL(&lock);
+    addDwellTime(esp_timer_get_time());
+    portEXIT_CRITICAL(&lock);
+  }
+
+  /// Returns true while hopping
+  bool isActive() const { return is_active; }
+
+  /// Statistics of the indicated channel
+  channel_hop_stats_t getChannelStats(channel_t channel) const {
+    int idx = statsIndex(static_cast<uint8_t>(channel));
+    if (idx < 0) return channel_hop_stats_t{};
+    channel_hop_stats_t result;
+    result.frames = frame_counts[idx].load(std::memory_order_relaxed);
+    portENTER_CRITICAL(&lock);
+    result.dwell_us = dwell_times_us[idx];
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  /// Number of channel changes
+  uint32_t getHopCount() const {
+    portENTER_CRITICAL(&lock);
+    uint32_t result = hop_count;
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  /// Average duration of a channel change in microseconds
+  uint32_t getHopTimeAvgUs() const {
+    portENTER_CRITICAL(&lock);
+    uint32_t result = hop_count == 0 ? 0 : hop_total_us / hop_count;
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  /// Maximum duration of a channel change in microseconds
+  uint32_t getHopTimeMaxUs() const {
+    portENTER_CRITICAL(&lock);
+    uint32_t result = hop_max_us;
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  /// Resets the channel and hop statistics
+  void resetStatistics() {
+    for (auto& count : frame_counts) count.store(0, std::memory_order_relaxed);
+    portENTER_CRITICAL(&lock);
+    for (auto& dwell : dwell_times_us) dwell = 0;
+    hop_count = 0;
+    hop_total_us = 0;
+    hop_max_us = 0;
+    channel_start_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&lock);
+  }
+
+  /// Counts a received frame: called by the transceiver in the receive ISR
+  void onReceive(const esp_ieee802154_frame_info_t& info) {
+    int idx = statsIndex(info.channel);
+    if (idx >= 0) frame_counts[idx].fetch_add(1, std::memory_order_relaxed);
+    slot_frames.fetch_add(1, std::memory_order_relaxed);
+  }
+
+ protected:
+  static constexpr const char* TAG = "ChannelHopper";
+  ESP32TransceiverIEEE802_15_4* p_transceiver = nullptr;
+  std::vector<channel_t> channels;
+  // statistics of the channels 11 to 26: the frames are counted in the ISR
+  std::atomic<uint32_t> frame_counts[16] = {};
+  uint64_t dwell_times_us[16] = {};
+  esp_timer_handle_t timer = nullptr;
+  size_t channel_idx = 0;
+  channel_t current_channel = channel_t::UNDEFINED;
+  uint32_t dwell_us = 100000;
+  uint32_t max_dwell_us = 0;
+  uint64_t channel_start_us = 0;  // start of the current dwell accounting
+  uint64_t channel_enter_us = 0;  // time when the channel was entered
+  std::atomic<uint32_t> slot_frames{0};  // frames in the current dwell time
+  uint32_t hop_count = 0;
+  uint64_t hop_total_us = 0;
+  uint32_t hop_max_us = 0;
+  bool is_active = false;
+  // protects the dwell times and hop statistics
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+  static int statsIndex(uint8_t channel) {
+    return channel >= 11 && channel <= 26 ? channel - 11 : -1;
+  }
+
+  static void onTimer(void* arg) {
+    static_cast<ChannelHopper*>(arg)->onDwellTimeEnd();
+  }
+
+  void onDwellTimeEnd() {
+    if (!is_active) return;
+    uint64_t now = esp_timer_get_time();
+    uint32_t frames = slot_frames.exchange(0, std::memory_order_relaxed);
+
+    // linger on a busy channel
+    bool stay = max_dwell_us > 0 && frames > 0 &&
+                now - channel_enter_us + dwell_us <= max_dwell_us;
+
+    if (!stay && channels.size() > 1) {
+      size_t next_idx = (channel_idx + 1) % channels.size();
+      if (hop(channels[next_idx])) channel_idx = next_idx;
+    }
+    esp_timer_start_once(timer, dwell_us);
+  }
+
+  /**
+   * @brief Switches the radio to the channel and measures the duration:
+   * returns false if a frame is being transmitted, because the channel change
+   * would abort the transmission.
+   */
+  bool hop(channel_t channel) {
+    RadioDispatcher& radio = RadioDispatcher::instance();
+    portENTER_CRITICAL(&radio.tx_lock);
+    bool transmitting = radio.tx_owner != nullptr;
+    uint64_t start = esp_timer_get_time();
+    bool ok = !transmitting &&
+              esp_ieee802154_set_channel(static_cast<uint8_t>(channel)) ==
+                  ESP_OK &&
+              esp_ieee802154_receive() == ESP_OK;
+    uint64_t end = esp_timer_get_time();
+    portEXIT_CRITICAL(&radio.tx_lock);
+    if (transmitting) return false;
+    if (!ok) {
+      ESP_LOGE(TAG, "Failed to change to channel %d", channel);
+      return false;
+    }
+
+    portENTER_CRITICAL(&lock);
+    addDwellTime(start);
+    uint32_t hop_us = end - start;
+    hop_count++;
+    hop_total_us += hop_us;
+    if (hop_us > hop_max_us) hop_max_us = hop_us;
+    current_channel = channel;
+    channel_start_us = channel_enter_us = end;
+    portEXIT_CRITICAL(&lock);
+    slot_frames.store(0, std::memory_order_relaxed);
+    // keep getChannel() of all transceivers up to date
+    radio.updateChannel(channel);
+    return true;
+  }
+
+  /// Adds the time since the last accounting to the current channel: must
+  /// be called with the lock
+  void addDwellTime(uint64_t now) {
+    int idx = statsIndex(static_cast<uint8_t>(current_channel));
+    if (idx >= 0) dwell_times_us[idx] += now - channel_start_us;
+    channel_start_us = now;
+  }
+};
+
+}  // namespace ieee802154
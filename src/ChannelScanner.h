@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "RadioDispatcher.h"
+#include "esp_ieee802154.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Energy statistics of a scanned channel in dBm.
+ */
+struct channel_energy_t {
+  channel_t channel = channel_t::UNDEFINED;
+  uint16_t samples = 0;   // Number of measurements
+  int8_t min_dbm = 0;     // Lowest measured energy
+  int8_t max_dbm = 0;     // Highest measured energy
+  int32_t total_dbm = 0;  // Sum of all measurements
+
+  /// Average energy in dBm, rounded to the nearest value
+  int8_t avgDbm() const {
+    if (samples == 0) return 0;
+    int32_t half = total_dbm < 0 ? -(samples / 2) : samples / 2;
+    return (total_dbm + half) / samples;
+  }
+
+  /// Adds a measurement
+  void add(int8_t dbm) {
+    if (samples == 0 || dbm < min_dbm) min_dbm = dbm;
+    if (samples == 0 || dbm > max_dbm) max_dbm = dbm;
+    total_dbm += dbm;
+    samples++;
+  }
+};
+
+/**
+ * @brief Measures the energy on a set of channels with
+ * esp_ieee802154_energy_detect(), so that the quietest channel can be selected
+ * before calling begin().
+ *
+ * Each channel is measured repeatedly for the dwell time: the results are
+ * ranked by the average energy, channels with the same average by the peak
+ * energy (e.g. of Wi-Fi bursts), so that the quietest channel comes first.
+ * A channel on which a measurement fails is skipped.
+ *
+ * The radio must not be in use by a transceiver while scanning.
+ *
+ * Example:
+ * @code
+ * ChannelScanner scanner;
+ * scanner.setChannels({channel_t::CHANNEL_11, channel_t::CHANNEL_15,
+ *                      channel_t::CHANNEL_20, channel_t::CHANNEL_25});
+ * scanner.scan(transceiver);  // selects the quietest channel
+ * transceiver.begin();
+ * @endcode
+ */
+class ChannelScanner {
+ public:
+  /// Scans all channels from 11 to 26 by default
+  ChannelScanner() {
+    for (int ch = 11; ch <= 26; ch++) {
+      channels.push_back(static_cast<channel_t>(ch));
+    }
+  }
+
+  ~ChannelScanner() {
+    if (semaphore) vSemaphoreDelete(semaphore);
+  }
+
+  /// Defines the channels to scan
+  void setChannels(std::initializer_list<channel_t> list) {
+    channels.assign(list.begin(), list.end());
+  }
+
+  /// Defines the time in milliseconds that is spent on each channel
+  void setDwellTimeMs(uint32_t ms) { dwell_time_ms = ms; }
+
+  /// Time in milliseconds that is spent on each channel
+  uint32_t getDwellTimeMs() const { return dwell_time_ms; }
+
+  /**
+   * @brief Defines the duration of a single energy measurement: it is rounded
+   * to the symbol time of 16 us.
+   */
+  void setSampleDurationUs(uint32_t us) {
+    sample_symbols = us / SYMBOL_TIME_US > 0 ? us / SYMBOL_TIME_US : 1;
+  }
+
+  /// Duration of a single energy measurement in microseconds
+  uint32_t getSampleDurationUs() const {
+    return sample_symbols * SYMBOL_TIME_US;
+  }
+
+  /**
+   * @brief Measures the energy on all channels.
+   * @return true if at least one channel could be measured.
+   */
+  bool scan() {
+    results.clear();
+    RadioDispatcher& radio = RadioDispatcher::instance();
+    if (radio.size() > 0) {
+      ESP_LOGE(TAG, "Cannot scan while a transceiver uses the radio");
+      return false;
+    }
+    if (semaphore == nullptr) {
+      semaphore = xSemaphoreCreateBinaryStatic(&semaphore_buffer);
+    }
+    if (esp_ieee802154_enable() != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to enable the radio");
+      return false;
+    }
+    radio.setEnergyDetectCallback(onEnergyDetect, this);
+
+    // the dwell time is spent with back to back measurements
+    uint32_t count = dwell_time_ms * 1000 / getSampleDurationUs();
+    if (count == 0) count = 1;
+    TickType_t timeout = pdMS_TO_TICKS(getSampleDurationUs() / 1000 + 10);
+    for (channel_t channel : channels) {
+      if (esp_ieee802154_set_channel(static_cast<uint8_t>(channel)) !=
+          ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set channel %d", channel);
+        continue;
+      }
+      channel_energy_t result;
+      result.channel = channel;
+      bool failed = false;
+      for (uint32_t j = 0; j < count && !failed; j++) {
+        xSemaphoreTake(semaphore, 0);  // clear outdated signal
+        failed = esp_ieee802154_energy_detect(sample_symbols) != ESP_OK ||
+                 xSemaphoreTake(semaphore, timeout) != pdTRUE;
+        if (!failed) result.add(last_power);
+      }
+      if (failed) {
+        // the following measurements would most likely fail as well
+        ESP_LOGW(TAG, "Energy detection failed on channel %d: skipped",
+                 channel);
+        continue;
+      }
+      ESP_LOGI(TAG, "Channel %d: avg %d dBm, max %d dBm", channel,
+               result.avgDbm(), result.max_dbm);
+      results.push_back(result);
+    }
+
+    radio.setEnergyDetectCallback(nullptr, nullptr);
+    esp_ieee802154_disable();
+
+    std::stable_sort(results.begin(), results.end(),
+                     [](const channel_energy_t& a, const channel_energy_t& b) {
+                       if (a.avgDbm() != b.avgDbm()) {
+                         return a.avgDbm() < b.avgDbm();
+                       }
+                       return a.max_dbm < b.max_dbm;
+                     });
+    return !results.empty();
+  }
+
+  /**
+   * @brief Measures the energy on all channels and sets the quietest channel
+   * in the transceiver.
+   * @return true if a channel was selected.
+   */
+  bool scan(ESP32TransceiverIEEE802_15_4& transceiver) {
+    if (!scan()) return false;
+    ESP_LOGI(TAG, "Selecting channel %d", bestChannel());
+    return transceiver.setChannel(bestChannel());
+  }
+
+  /// Scanned channels ranked from the quietest to the noisiest
+  const std::vector<channel_energy_t>& getResults() const { return results; }
+
+  /// Quietest channel of the last scan
+  channel_t bestChannel() const {
+    return results.empty() ? channel_t::UNDEFINED : results[0].channel;
+  }
+
+ protected:
+  static constexpr const char* TAG = "ChannelScanner";
+  static constexpr uint32_t SYMBOL_TIME_US = 16;
+  std::vector<channel_t> channels;
+  std::vector<channel_energy_t> results;
+  uint32_t dwell_time_ms = 100;
+  uint32_t sample_symbols = 8;  // 128 us as the standard ED duration
+  SemaphoreHandle_t semaphore = nullptr;
+  StaticSemaphore_t semaphore_buffer;
+  volatile int8_t last_power = 0;
+
+  static void onEnergyDetect(int8_t power, void* user_data) {
+    ChannelScanner& self = *static_cast<ChannelScanner*>(user_data);
+    self.last_power = power;
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(self.semaphore, &higher_priority_task_woken);
+    if (higher_priority_task_woken) {
+      portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+  }
+};
+
+}  // namespace ieee802154
@@ -0,0 +1,410 @@
+#pragma once
+
+#include <string.h>
+
+#include <vector>
+
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Callback for a reassembled datagram.
+ * @param source Address of the sender.
+ * @param data The datagram.
+ * @param len Length of the datagram.
+ * @param user_data User data pointer.
+ */
+typedef void (*datagram_rx_callback_t)(Address& source, const uint8_t* data,
+                                       size_t len, void* user_data);
+
+/**
+ * @brief Message oriented transport: datagrams of up to 4 KB are split into
+ * fragments that fit into a frame and are reassembled by the receiver.
+ *
+ * Each fragment starts with a 4 byte header:
+ *
+ *   | tag (1) | datagram size (2, little endian) | offset / 16 (1) |
+ *
+ * The payload of all fragments but the last is a multiple of 16 bytes, so
+ * that the offset fits into one byte. The receiver collects the fragments of
+ * a datagram in a reassembly buffer that is identified by the source address
+ * and the tag: the fragments can arrive in any order and duplicates are
+ * ignored. The complete datagram is delivered to the rx callback in the
+ * receive task of the transceiver.
+ *
+ * A delivered datagram keeps its buffer until the timeout, so that late
+ * duplicates are ignored. As the 8 bit tag wraps around, the receiver also
+ * keeps the tag of the last datagram delivered from each source: a fragment
+ * that matches a delivered datagram with another tag than the last one
+ * starts a new datagram in its buffer.
+ *
+ * The number of reassembly buffers is bounded: a buffer that did not receive
+ * a fragment within the reassembly timeout is released, and a fragment of a
+ * new datagram is dropped while all buffers are in use. Lost fragments are
+ * not sent again: a datagram that misses a fragment is discarded by the
+ * timeout.
+ *
+ * The transport takes over the rx and the tx complete callback of the
+ * transceiver: begin() registers its own callbacks and end() removes them,
+ * so they must not be changed by the application in between.
+ *
+ * Example:
+ * @code
+ * DatagramTransport datagrams(transceiver);
+ * datagrams.setRxCallback(onDatagram, nullptr);
+ * transceiver.begin();
+ * datagrams.begin();
+ * datagrams.send(peer, data, 1000);
+ * @endcode
+ */
+class DatagramTransport {
+ public:
+  /// Maximum size of a datagram
+  static constexpr size_t MAX_DATAGRAM_SIZE = 4096;
+  /// Size of the fragment header
+  static constexpr size_t HEADER_SIZE = 4;
+
+  DatagramTransport(ESP32TransceiverIEEE802_15_4& transceiver)
+      : p_transceiver(&transceiver) {}
+
+  ~DatagramTransport() {
+    end();
+    if (tx_semaphore) vSemaphoreDelete(tx_semaphore);
+    if (rx_mutex) vSemaphoreDelete(rx_mutex);
+  }
+
+  /// Defines the callback for the reassembled datagrams
+  void setRxCallback(datagram_rx_callback_t callback, void* user_data) {
+    rx_callback = callback;
+    rx_callback_user_data = user_data;
+  }
+
+  /// Defines the number of datagrams that can be reassembled concurrently
+  void setReassemblyBufferCount(int count) { buffer_count = count; }
+
+  /**
+   * @brief Defines the size of the reassembly buffers and the largest
+   * datagram that can be received (max 4096 bytes)
+   */
+  void setMaxDatagramSize(size_t size) {
+    max_datagram_size = size < MAX_DATAGRAM_SIZE ? size : MAX_DATAGRAM_SIZE;
+  }
+
+  /// Defines the time after which an incomplete datagram is discarded
+  void setReassemblyTimeoutMs(uint32_t ms) { timeout_ms = ms; }
+
+  /**
+   * @brief Allocates the reassembly buffers and registers the callbacks at
+   * the transceiver: replaces its rx and tx complete callbacks.
+   */
+  bool begin() {
+    if (buffer_count <= 0 || max_datagram_size == 0) {
+      ESP_LOGE(TAG, "No reassembly buffers defined");
+      return false;
+    }
+    if (tx_semaphore == nullptr) {
+      tx_semaphore = xSemaphoreCreateBinaryStatic(&tx_semaphore_buffer);
+    }
+    if (rx_mutex == nullptr) {
+      rx_mutex = xSemaphoreCreateMutexStatic(&rx_mutex_buffer);
+    }
+    end();
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    buffers.resize(buffer_count);
+    for (auto& buffer : buffers) {
+      buffer.data.resize(max_datagram_size);
+    }
+    sources.resize(buffer_count);
+    is_active = true;
+    xSemaphoreGive(rx_mutex);
+    p_transceiver->setRxCallback(onReceive, this);
+    p_transceiver->setTxCompleteCallback(onTxComplete, this);
+    return true;
+  }
+
+  /**
+   * @brief Removes the callbacks from the transceiver and releases the
+   * reassembly buffers: waits while the receive task is processing a
+   * fragment, so it must not be called from the rx callback.
+   */
+  void end() {
+    if (!is_active) return;
+    p_transceiver->setRxCallback(nullptr, nullptr);
+    p_transceiver->setTxCompleteCallback(nullptr, nullptr);
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    is_active = false;
+    buffers.clear();
+    buffers.shrink_to_fit();
+    sources.clear();
+    sources.shrink_to_fit();
+    xSemaphoreGive(rx_mutex);
+  }
+
+  /**
+   * @brief Sends the datagram to the destination: the fragments are queued
+   * back to back and we wait while the TX queue is full.
+   * @return false if the datagram is too long or a fragment could not be
+   * queued.
+   */
+  bool send(const Address& destination, const uint8_t* data, size_t len) {
+    p_transceiver->setDestinationAddress(destination);
+    return send(data, len);
+  }
+
+  /// Sends the datagram to the destination address of the transceiver
+  bool send(const uint8_t* data, size_t len) {
+    if (len == 0 || len > MAX_DATAGRAM_SIZE) {
+      ESP_LOGE(TAG, "Invalid datagram size: %d", len);
+      return false;
+    }
+    size_t max_payload = p_transceiver->getMaxPayloadSize();
+    if (max_payload < HEADER_SIZE + BLOCK_SIZE) return false;
+    size_t fragment_size =
+        (max_payload - HEADER_SIZE) / BLOCK_SIZE * BLOCK_SIZE;
+
+    uint8_t header[HEADER_SIZE];
+    header[0] = ++tx_tag;
+    header[1] = len & 0xFF;
+    header[2] = len >> 8;
+    for (size_t offset = 0; offset < len; offset += fragment_size) {
+      size_t n = len - offset < fragment_size ? len - offset : fragment_size;
+      header[3] = offset / BLOCK_SIZE;
+      tx_segment_t segments[2] = {{header, HEADER_SIZE}, {data + offset, n}};
+      waitForTxQueue();
+      if (p_transceiver->sendAsync(segments, 2) == 0) {
+        ESP_LOGE(TAG, "Failed to send fragment at %d of %d", offset, len);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Number of delivered datagrams
+  uint32_t getReceivedCount() const { return received_count; }
+
+  /// Number of incomplete datagrams that were discarded by the timeout
+  uint32_t getTimeoutCount() const { return timeout_count; }
+
+  /// Number of fragments that were invalid or found no reassembly buffer
+  uint32_t getDroppedCount() const { return dropped_count; }
+
+ protected:
+  static constexpr size_t BLOCK_SIZE = 16;  // unit of the fragment offset
+  struct reassembly_t {
+    bool active = false;    // collecting fragments
+    bool complete = false;  // delivered: detects late duplicates
+    uint8_t src[8];
+    uint8_t src_len = 0;
+    uint8_t tag = 0;
+    uint16_t size = 0;
+    uint16_t received = 0;  // number of received bytes
+    uint64_t last_us = 0;   // time of the last fragment
+    uint32_t blocks[MAX_DATAGRAM_SIZE / BLOCK_SIZE / 32];  // received blocks
+    std::vector<uint8_t> data;
+  };
+  struct source_tag_t {
+    uint64_t key = 0;      // source address, see addressKey()
+    uint8_t key_len = 0;   // 0 for an unused entry
+    uint8_t tag = 0;       // tag of the last delivered datagram
+    uint64_t last_us = 0;  // for the replacement of the oldest source
+  };
+  static constexpr const char* TAG = "DatagramTransport";
+  static constexpr uint32_t TX_QUEUE_TIMEOUT_MS = 1000;
+  ESP32TransceiverIEEE802_15_4* p_transceiver = nullptr;
+  std::vector<reassembly_t> buffers;
+  std::vector<source_tag_t> sources;
+  int buffer_count = 4;
+  size_t max_datagram_size = MAX_DATAGRAM_SIZE;
+  uint32_t timeout_ms = 2000;
+  uint8_t tx_tag = 0;
+  uint32_t received_count = 0;
+  uint32_t timeout_count = 0;
+  uint32_t dropped_count = 0;
+  bool is_active = false;
+  datagram_rx_callback_t rx_callback = nullptr;
+  void* rx_callback_user_data = nullptr;
+  SemaphoreHandle_t tx_semaphore = nullptr;
+  StaticSemaphore_t tx_semaphore_buffer;
+  SemaphoreHandle_t rx_mutex = nullptr;  // protects the buffers in end()
+  StaticSemaphore_t rx_mutex_buffer;
+
+  /// Waits until the radio has finished a frame if the TX queue is full
+  void waitForTxQueue() {
+    uint64_t start = esp_timer_get_time();
+    while (p_transceiver->getTxQueueAvailable() == 0 &&
+           esp_timer_get_time() - start < TX_QUEUE_TIMEOUT_MS * 1000) {
+      xSemaphoreTake(tx_semaphore, pdMS_TO_TICKS(TX_QUEUE_TIMEOUT_MS));
+    }
+  }
+
+  static void onTxComplete(uint32_t token, esp_ieee802154_tx_error_t error,
+                           void* user_data) {
+    DatagramTransport& self = *static_cast<DatagramTransport*>(user_data);
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(self.tx_semaphore, &higher_priority_task_woken);
+    if (higher_priority_task_woken) {
+      portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+  }
+
+  static void onReceive(Frame& frame, esp_ieee802154_frame_info_t& info,
+                        void* user_data) {
+    DatagramTransport& self = *static_cast<DatagramTransport*>(user_data);
+    xSemaphoreTake(self.rx_mutex, portMAX_DELAY);
+    if (self.is_active) self.receive(frame);
+    xSemaphoreGive(self.rx_mutex);
+  }
+
+  void receive(Frame& frame) {
+    if (frame.payloadLen <= HEADER_SIZE) {
+      dropped_count++;
+      return;
+    }
+    const uint8_t* header = frame.payload;
+    uint8_t tag = header[0];
+    size_t size = header[1] | (header[2] << 8);
+    size_t offset = header[3] * BLOCK_SIZE;
+    const uint8_t* data = frame.payload + HEADER_SIZE;
+    size_t len = frame.payloadLen - HEADER_SIZE;
+    // all fragments but the last are made of complete blocks
+    bool valid = size > 0 && size <= max_datagram_size &&
+                 offset + len <= size &&
+                 (offset + len == size || len % BLOCK_SIZE == 0);
+    if (!valid) {
+      dropped_count++;
+      return;
+    }
+
+    Address source(frame.srcAddress, addressMode(frame.srcAddrLen));
+    uint64_t now = esp_timer_get_time();
+    if (offset == 0 && len == size) {
+      // not fragmented
+      deliver(source, tag, data, len, now);
+      return;
+    }
+
+    releaseExpired(now);
+    reassembly_t* buffer = find(frame, tag, size);
+    source_tag_t* last = findSource(source);
+    if (buffer != nullptr && buffer->complete && last != nullptr &&
+        last->tag != tag) {
+      // the tag wrapped around: a new datagram
+      start(*buffer, frame, tag, size);
+    }
+    if (buffer == nullptr) buffer = allocate(frame, tag, size);
+    if (buffer == nullptr) {
+      ESP_LOGW(TAG, "No reassembly buffer: dropping fragment");
+      dropped_count++;
+      return;
+    }
+    buffer->last_us = now;
+
+    // ignore duplicates
+    if (buffer->complete) return;
+    size_t block = offset / BLOCK_SIZE;
+    if (buffer->blocks[block / 32] & (1u << (block % 32))) return;
+    size_t block_end = (offset + len + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for (size_t j = block; j < block_end; j++) {
+      buffer->blocks[j / 32] |= 1u << (j % 32);
+    }
+    memcpy(buffer->data.data() + offset, data, len);
+    buffer->received += len;
+
+    if (buffer->received == buffer->size) {
+      buffer->active = false;
+      buffer->complete = true;
+      deliver(source, tag, buffer->data.data(), buffer->size, now);
+    }
+  }
+
+  void deliver(Address& source, uint8_t tag, const uint8_t* data, size_t len,
+               uint64_t now) {
+    source_tag_t* entry = findSource(source);
+    if (entry == nullptr) {
+      // replace the source with the oldest delivery
+      entry = &sources[0];
+      for (auto& candidate : sources) {
+        if (candidate.last_us < entry->last_us) entry = &candidate;
+      }
+      entry->key = source.key();
+      entry->key_len = source.length();
+    }
+    entry->tag = tag;
+    entry->last_us = now;
+    received_count++;
+    if (rx_callback) rx_callback(source, data, len, rx_callback_user_data);
+  }
+
+  source_tag_t* findSource(const Address& source) {
+    uint64_t key = source.key();
+    for (auto& entry : sources) {
+      if (entry.key_len == source.length() && entry.key == key) return &entry;
+    }
+    return nullptr;
+  }
+
+  /// Releases the buffers that did not receive a fragment in time
+  void releaseExpired(uint64_t now) {
+    for (auto& buffer : buffers) {
+      if (now - buffer.last_us <= timeout_ms * 1000ull) continue;
+      if (buffer.active) {
+        ESP_LOGW(TAG, "Reassembly timeout: %d of %d bytes", buffer.received,
+                 buffer.size);
+        timeout_count++;
+      }
+      buffer.active = false;
+      buffer.complete = false;
+    }
+  }
+
+  reassembly_t* find(const Frame& frame, uint8_t tag, size_t size) {
+    for (auto& buffer : buffers) {
+      if ((buffer.active || buffer.complete) && buffer.tag == tag &&
+          buffer.size == size &&
+          buffer.src_len == frame.srcAddrLen &&
+          memcmp(buffer.src, frame.srcAddress, frame.srcAddrLen) == 0) {
+        return &buffer;
+      }
+    }
+    return nullptr;
+  }
+
+  reassembly_t* allocate(const Frame& frame, uint8_t tag, size_t size) {
+    for (auto& buffer : buffers) {
+      if (buffer.active) continue;
+      start(buffer, frame, tag, size);
+      return &buffer;
+    }
+    return nullptr;
+  }
+
+  void start(reassembly_t& buffer, const Frame& frame, uint8_t tag,
+             size_t size) {
+    buffer.active = true;
+    buffer.complete = false;
+    buffer.tag = tag;
+    buffer.size = size;
+    buffer.received = 0;
+    buffer.src_len = frame.srcAddrLen;
+    memcpy(buffer.src, frame.srcAddress, frame.srcAddrLen);
+    memset(buffer.blocks, 0, sizeof(buffer.blocks));
+  }
+
+  static addr_mode_t addressMode(uint8_t len) {
+    switch (len) {
+      case 2:
+        return addr_mode_t::SHORT;
+      case 8:
+        return addr_mode_t::EXTENDED;
+      default:
+        return addr_mode_t::NONE;
+    }
+  }
+};
+
+}  // namespace ieee802154
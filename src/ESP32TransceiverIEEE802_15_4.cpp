@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "ChannelHopper.h"
 #include "esp_ieee802154.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
@@ -14,9 +15,6 @@
 
 namespace ieee802154 {
 
-/// accessible by global callback functions
-ESP32TransceiverIEEE802_15_4* pt_transceiver = nullptr;
-
 /// Forward declarations
 void receive_packet_task(void* pvParameters);
 
@@ -46,84 +44,75 @@ bool ESP32TransceiverIEEE802_15_4::begin() {
     return false;
   }
 
-  // Create message buffer
-  ESP_LOGI(TAG, "Creating message buffer of size %d bytes",
-           receive_msg_buffer_size);
-  message_buffer = xMessageBufferCreate(receive_msg_buffer_size);
-  if (!message_buffer) {
-    ESP_LOGE(TAG, "Failed to create message buffer");
-    end();
-    return false;
-  }
-
-  // Initialize IEEE 802.15.4 radio
-  ret = esp_ieee802154_enable();
-  ESP_LOGI(TAG, "Enabling IEEE 802.15.4 radio");
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to enable IEEE 802.15.4 radio: %d", ret);
-    end();
-    return false;
+  // Create frame pool
+  if (frame_pool_size > 0) {
+    ESP_LOGI(TAG, "Creating frame pool with %d slots", frame_pool_size);
+    frame_pool.resize(frame_pool_size);
+    frame_pool_semaphore =
+        xSemaphoreCreateBinaryStatic(&frame_pool_semaphore_buffer);
+    if (!frame_pool_semaphore) {
+      ESP_LOGE(TAG, "Failed to create frame pool semaphore");
+      end();
+      return false;
+    }
   }
-  radio_enabled = true;
 
-  ret = esp_ieee802154_set_coordinator(is_coordinator);
-  ESP_LOGI(TAG, "Setting coordinator mode to %s",
-           is_coordinator ? "true" : "false");
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to set coordinator mode to false: %d", ret);
-    end();
-    return false;
+  // Create TX queue
+  if (tx_queue_storage != nullptr) {
+    tx_queue = tx_queue_storage;
+  } else {
+    tx_queue_buffer.resize(tx_queue_size);
+    tx_queue = tx_queue_buffer.data();
   }
+  tx_queue_len = tx_queue_size;
+  tx_head = tx_tail = tx_count = 0;
 
-  ret = esp_ieee802154_set_promiscuous(is_promiscuous_mode);
-  ESP_LOGI(TAG, "Setting promiscuous mode to %s",
-           is_promiscuous_mode ? "true" : "false");
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to enable promiscuous mode: %d", ret);
+  // Create message buffer
+  ESP_LOGI(TAG, "Creating message buffer of size %d bytes",
+           receive_msg_buffer_size);
+  if (!createMessageBuffer()) {
+    ESP_LOGE(TAG, "Failed to create message buffer");
     end();
     return false;
   }
 
-  ret = esp_ieee802154_set_rx_when_idle(is_rx_when_idle);
-  ESP_LOGI(TAG, "Setting rx when idle to %s",
-           is_rx_when_idle ? "true" : "false");
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to set rx when idle: %d", ret);
-    end();
-    return false;
+  // Register at the radio: the first transceiver enables it
+  RadioDispatcher& radio = RadioDispatcher::instance();
+  if (radio.size() > 0 && radio.get(0)->channel != channel) {
+    ESP_LOGW(TAG, "Channel %d differs from the channel %d of the radio: using "
+             "the channel of the radio", channel, radio.get(0)->channel);
+    channel = radio.get(0)->channel;
   }
-
-  ret = esp_ieee802154_set_panid(panID);
-  ESP_LOGI(TAG, "Setting PAN ID to 0x%04X", panID);
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to set PAN ID: %d", ret);
+  if (!radio.add(this)) {
+    ESP_LOGE(TAG, "Failed to register at the radio");
     end();
     return false;
   }
+  radio_enabled = true;
 
-  ret = esp_ieee802154_set_channel(static_cast<uint8_t>(channel));
-  ESP_LOGI(TAG, "Setting channel to %d", (int)channel);
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to set channel %d: %d", channel, ret);
-    end();
-    return false;
-  }
+  if (radio.size() == 1) {
+    // Initialize IEEE 802.15.4 radio
+    ret = esp_ieee802154_enable();
+    ESP_LOGI(TAG, "Enabling IEEE 802.15.4 radio");
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to enable IEEE 802.15.4 radio: %d", ret);
+      end();
+      return false;
+    }
 
-  ESP_LOGI(TAG, "Setting local address: %s", local_address.to_str());
-  if (local_address.mode() == addr_mode_t::SHORT) {
-    ret = esp_ieee802154_set_short_address(*(uint16_t*)local_address.data());
-  } else if (local_address.mode() == addr_mode_t::EXTENDED) {
-    ret = esp_ieee802154_set_extended_address(local_address.data());
-  }
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to set local address: %d", ret);
-    end();
-    return false;
+    ret = esp_ieee802154_set_channel(static_cast<uint8_t>(channel));
+    ESP_LOGI(TAG, "Setting channel to %d", (int)channel);
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to set channel %d: %d", channel, ret);
+      end();
+      return false;
+    }
   }
 
-  ret = esp_ieee802154_receive();
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to start receiving: %d", ret);
+  // Coordinator, rx when idle, promiscuous mode, PAN ID and address of all
+  // transceivers: starts receiving
+  if (!radio.updateFilter()) {
+    ESP_LOGE(TAG, "Failed to start receiving");
     end();
     return false;
   }
@@ -135,8 +124,9 @@ bool ESP32TransceiverIEEE802_15_4::begin() {
 
   // Start receive task
   if (receive_packet_task != nullptr) {
-    if (xTaskCreate(receive_packet_task, "RX", 1024 * 5, this, 5,
-                    &rx_task_handle) != pdPASS) {
+    rx_task_handle =
+        rx_task_config.create(receive_packet_task, this, &rx_task_buffer);
+    if (rx_task_handle == nullptr) {
       ESP_LOGE(TAG, "Failed to create receive task");
       end();
       return false;
@@ -154,6 +144,17 @@ bool ESP32TransceiverIEEE802_15_4::begin() {
 bool ESP32TransceiverIEEE802_15_4::end(void) {
   esp_err_t ret;
 
+  // Unregister from the radio, so that no more frames are routed to us
+  RadioDispatcher& radio = RadioDispatcher::instance();
+  bool disable_radio = false;
+  if (p_channel_hopper) p_channel_hopper->end();
+  if (radio_enabled) {
+    radio.remove(this);
+    radio_enabled = false;
+    disable_radio = radio.size() == 0;
+    if (!disable_radio) radio.updateFilter();
+  }
+
   // Stop receive task
   if (rx_task_handle) {
     vTaskDelete(rx_task_handle);
@@ -166,14 +167,25 @@ bool ESP32TransceiverIEEE802_15_4::end(void) {
     message_buffer = NULL;
   }
 
-  // Disable radio
-  if (radio_enabled) {
+  // Drop queued frames
+  portENTER_CRITICAL(&radio.tx_lock);
+  tx_head = tx_tail = tx_count = 0;
+  portEXIT_CRITICAL(&radio.tx_lock);
+
+  // Free frame pool
+  if (frame_pool_semaphore) {
+    vSemaphoreDelete(frame_pool_semaphore);
+    frame_pool_semaphore = NULL;
+  }
+  frame_pool.resize(0);
+
+  // Disable radio when it is not used by any other transceiver
+  if (disable_radio) {
     ret = esp_ieee802154_disable();
     if (ret != ESP_OK) {
       ESP_LOGE(TAG, "Failed to disable IEEE 802.15.4 radio: %d", ret);
       return false;
     }
-    radio_enabled = false;
   }
   is_active = false;
   ESP_LOGI(TAG, "IEEE 802.15.4 transceiver deinitialized");
@@ -188,55 +200,196 @@ bool ESP32TransceiverIEEE802_15_4::setRxCallback(
   return true;
 }
 
-// Internal: Transmit an IEEE 802.15.4 frame
-esp_err_t ESP32TransceiverIEEE802_15_4::transmit_frame(Frame* frame) {
-  esp_err_t ret;
-
-  if (!is_active) {
-    ESP_LOGE(TAG, "Transceiver is not active");
-    return ESP_ERR_INVALID_STATE;
+bool ESP32TransceiverIEEE802_15_4::setRxBatchCallback(
+    ieee802154_transceiver_rx_batch_callback_t callback, void* user_data,
+    size_t max_batch_size, uint32_t max_latency_ms) {
+  // the receive task uses the batch buffers
+  if (is_active) {
+    ESP_LOGW(TAG, "Cannot change batch callback while active");
+    return false;
+  }
+  if (max_batch_size == 0) {
+    ESP_LOGE(TAG, "Invalid batch size: %d", max_batch_size);
+    return false;
   }
+  rx_batch_callback_ = callback;
+  rx_batch_callback_user_data_ = user_data;
+  rx_batch_max_latency = pdMS_TO_TICKS(max_latency_ms);
+  rx_batch_frames.resize(max_batch_size);
+  rx_batch_infos.resize(max_batch_size);
+  rx_batch_packets.resize(max_batch_size);
+  rx_batch_dequeue_us.resize(max_batch_size);
+  // allocate now, so that receiving does not need the heap
+  if (frame_pool_size == 0) rx_batch_storage.resize(max_batch_size);
+  ESP_LOGI(TAG, "Receive batch callback set with batch size %d",
+           max_batch_size);
+  return true;
+}
 
+bool ESP32TransceiverIEEE802_15_4::setTxCompleteCallback(
+    ieee802154_transceiver_tx_complete_callback_t callback, void* user_data) {
+  tx_complete_callback_ = callback;
+  tx_complete_callback_user_data_ = user_data;
+  return true;
+}
+
+// Internal: Queue an IEEE 802.15.4 frame for transmission
+uint32_t ESP32TransceiverIEEE802_15_4::transmit_frame(Frame* frame) {
   if (!frame) {
     ESP_LOGE(TAG, "Invalid frame pointer");
-    return ESP_ERR_INVALID_ARG;
+    return 0;
   }
 
   // Prepare buffer
-  memset(transmit_buffer, 0, MAX_FRAME_LEN);  // Clear
-  // Build frame into a byte array
-  size_t len = frame->build(transmit_buffer, false);
+  tx_slot_t* slot = beginTxSlot();
+  if (slot == nullptr) return 0;
+  memset(slot->frame, 0, MAX_FRAME_LEN);  // Clear
+  // Build frame into a byte array and queue it
+  return endTxSlot(slot, frame->build(slot->frame, false));
+}
+
+// Internal: Provides the TX queue entry to build the next frame into
+tx_slot_t* ESP32TransceiverIEEE802_15_4::beginTxSlot() {
+  if (!is_active) {
+    ESP_LOGE(TAG, "Transceiver is not active");
+    return nullptr;
+  }
+  tx_slot_t* slot = reserveTxSlot();
+  if (slot == nullptr) {
+    ESP_LOGE(TAG, "TX queue full");
+  }
+  return slot;
+}
+
+// Internal: Queues and transmits the frame that was built into the entry
+uint32_t ESP32TransceiverIEEE802_15_4::endTxSlot(tx_slot_t* slot, size_t len) {
   if (len == 0) {
     ESP_LOGE(TAG, "Failed to build frame");
-    return ESP_FAIL;
+    return 0;
   }
 
-  // Transmit frame
-  ret = esp_ieee802154_transmit(transmit_buffer, cca_enabled);
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to transmit %d frame: %d", frame->sequenceNumber,
-             ret);
-    return ret;
+  slot->tx_power = p_tx_power_controller
+                       ? p_tx_power_controller->powerFor(slot->frame)
+                       : TX_POWER_UNCHANGED;
+
+  // Queue and transmit frame
+  uint32_t token = commitTxSlot(slot);
+  if (token == 0) {
+    ESP_LOGE(TAG, "Failed to transmit frame");
+    return 0;
   }
 
   // Increment sequence number for next transmission
   if (auto_increment_sequence_number) incrementSequenceNumber();
-  return ESP_OK;
+  return token;
 }
 
-bool ESP32TransceiverIEEE802_15_4::send(uint8_t* data, size_t len) {
-  ESP_LOGI(TAG, "Sending frame %d on channel %d to address %s, len: %d",
+// Internal: Provides the next free TX queue entry. Single producer: the entry
+// is only reserved by committing it, so concurrent senders would share it.
+tx_slot_t* ESP32TransceiverIEEE802_15_4::reserveTxSlot() {
+  if (tx_queue_len == 0 || tx_count >= tx_queue_len) return nullptr;
+  return &tx_queue[tx_tail];
+}
+
+// Internal: Adds the reserved entry to the queue and starts the transmission
+// if the radio is idle. Otherwise the RadioDispatcher sends it when the
+// queued frames of all transceivers before it are done.
+uint32_t ESP32TransceiverIEEE802_15_4::commitTxSlot(tx_slot_t* slot) {
+  RadioDispatcher& radio = RadioDispatcher::instance();
+  portENTER_CRITICAL(&radio.tx_lock);
+  if (++tx_next_token == 0) tx_next_token = 1;
+  uint32_t token = tx_next_token;
+  slot->token = token;
+  tx_tail = (tx_tail + 1) % tx_queue_len;
+  tx_count++;
+  // the radio is idle only if all TX queues are empty
+  bool start = radio.tx_owner == nullptr;
+  if (start) radio.tx_owner = this;
+  portEXIT_CRITICAL(&radio.tx_lock);
+
+  if (start) {
+    esp_err_t ret = radio.transmit(this);
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to transmit frame: %d", ret);
+      // remove the frame again: it is the only one in the queue
+      portENTER_CRITICAL(&radio.tx_lock);
+      tx_tail = (tx_tail + tx_queue_len - 1) % tx_queue_len;
+      tx_count--;
+      if (radio.tx_owner == this) radio.tx_owner = nullptr;
+      portEXIT_CRITICAL(&radio.tx_lock);
+      stats.addTx(ESP_IEEE802154_TX_ERR_ABORT, 0);
+      // other transceivers might have queued frames in the meantime
+      radio.startTx();
+      return 0;
+    }
+  }
+  return token;
+}
+
+uint32_t ESP32TransceiverIEEE802_15_4::sendAsync(uint8_t* data, size_t len) {
+  tx_segment_t segment{data, len};
+  return sendAsync(&segment, 1);
+}
+
+uint32_t ESP32TransceiverIEEE802_15_4::sendAsync(const tx_segment_t* segments,
+                                                 size_t count) {
+  size_t len = 0;
+  for (size_t j = 0; j < count; j++) {
+    len += segments[j].len;
+  }
+  ESP_LOGD(TAG, "Sending frame %d on channel %d to address %s, len: %d",
            frame.sequenceNumber, channel, destination_address.to_str(), len);
+  size_t max_len = getMaxPayloadSize();
+  if (len > max_len) {
+    ESP_LOGE(TAG, "Payload too big: %d bytes (max %d)", len, max_len);
+    return 0;
+  }
+
+  tx_slot_t* slot = beginTxSlot();
+  if (slot == nullptr) return 0;
+  uint8_t* out = slot->frame;
+  memcpy(out + 1, tx_header, tx_header_len);
+  if (!frame.fcf.sequenceNumberSuppression) {
+    out[1 + IEEE802154_FCF_SIZE] = frame.sequenceNumber;
+  }
+  size_t offset = 1 + tx_header_len;
+  for (size_t j = 0; j < count; j++) {
+    memcpy(out + offset, segments[j].data, segments[j].len);
+    offset += segments[j].len;
+  }
+  out[offset] = 0x00;
+  out[0] = tx_header_len + len + 2;
+  return endTxSlot(slot, out[0]);
+}
+
+// Internal: Builds the header for send(uint8_t*, size_t) from the FCF, PAN
+// and addresses
+void ESP32TransceiverIEEE802_15_4::updateTxHeader() {
   frame.fcf = frame_control_field;
   frame.setPAN(panID);                    // Ensure PAN ID is set and compressed
   frame.setSourceAddress(local_address);  // Ensure source address is set
   frame.setDestinationAddress(
       destination_address);  // Ensure destination address is set
-  frame.setPayload(data, len);
-  return transmit_frame(&frame) == ESP_OK;
+  frame.payloadLen = 0;
+  uint8_t tmp[MAX_FRAME_LEN];
+  // length byte + header + trailing 0x00
+  tx_header_len = frame.build(tmp, false) - 2;
+  memcpy(tx_header, tmp + 1, tx_header_len);
+  tx_header_fcf = frame_control_field;
+  tx_header_valid = true;
 }
 
-bool ESP32TransceiverIEEE802_15_4::send(Frame& frame) {
+size_t ESP32TransceiverIEEE802_15_4::getMaxPayloadSize() {
+  // The FCF can also be changed via getFrameControlField()
+  if (!tx_header_valid || memcmp(&tx_header_fcf, &frame_control_field,
+                                 IEEE802154_FCF_SIZE) != 0) {
+    updateTxHeader();
+  }
+  // PSDU: header + payload + 2 bytes FCS
+  return MAX_FRAME_LEN - 3 - tx_header_len;
+}
+
+uint32_t ESP32TransceiverIEEE802_15_4::sendAsync(Frame& frame) {
   ESP_LOGI(TAG, "Sending frame %d on channel %d to address %s, len: %d",
            frame.sequenceNumber, channel, destination_address.to_str(),
            frame.payloadLen);
@@ -250,7 +403,7 @@ bool ESP32TransceiverIEEE802_15_4::send(Frame& frame) {
   if (frame.destAddrLen == 0) {
     frame.setDestinationAddress(destination_address);
   }
-  return transmit_frame(&frame) == ESP_OK;
+  return transmit_frame(&frame);
 }
 
 bool ESP32TransceiverIEEE802_15_4::setChannel(channel_t channel) {
@@ -262,8 +415,10 @@ bool ESP32TransceiverIEEE802_15_4::setChannel(channel_t channel) {
 
   this->channel = channel;
 
-  // If radio is active, change channel immediately
+  // If radio is active, change channel immediately for all transceivers
   if (radio_enabled) {
+    RadioDispatcher::instance().updateChannel(channel);
+
     esp_err_t ret;
 
     // Set channel
@@ -286,47 +441,104 @@ bool ESP32TransceiverIEEE802_15_4::setChannel(channel_t channel) {
 }
 
 void ESP32TransceiverIEEE802_15_4::setReceiveBufferSize(int size) {
-  if (size > sizeof(frame_data_t) + 4 && size != receive_msg_buffer_size) {
+  if (message_buffer_storage && (size_t)size >= message_buffer_storage_size) {
+    ESP_LOGE(TAG, "Receive message buffer size %d exceeds the storage", size);
+    return;
+  }
+  if (size >= sizeof(frame_record_t) + 4 && size != receive_msg_buffer_size) {
     receive_msg_buffer_size = size;
     ESP_LOGI(TAG, "Receive message buffer size set to %d bytes", size);
     if (message_buffer) {
       vMessageBufferDelete(message_buffer);
-      message_buffer = xMessageBufferCreate(receive_msg_buffer_size);
+      createMessageBuffer();
     }
   }
 }
 
-void ESP32TransceiverIEEE802_15_4::onRxDone(
-    uint8_t* frame, esp_ieee802154_frame_info_t* frame_info) {
-  ESP_LOGD(TAG, "Received frame with length %d, RSSI: %d, LQI: %d", frame[0],
-           frame_info->rssi, frame_info->lqi);
-  // Prepare packet
-  frame_data_t packet;
-  memcpy(packet.frame, frame, frame[0]);
-  packet.frame_info = *frame_info;
+bool ESP32TransceiverIEEE802_15_4::setReceiveBufferStorage(uint8_t* storage,
+                                                           size_t size) {
+  // the storage needs one byte more than the buffer size
+  if (storage == nullptr || size < sizeof(frame_record_t) + 4 + 1) {
+    ESP_LOGE(TAG, "Receive buffer storage of %d bytes is too small", size);
+    return false;
+  }
+  message_buffer_storage = storage;
+  message_buffer_storage_size = size;
+  receive_msg_buffer_size = size - 1;
+  return true;
+}
+
+// Internal: Creates the RX message buffer in the provided or allocated memory
+bool ESP32TransceiverIEEE802_15_4::createMessageBuffer() {
+  if (message_buffer_storage) {
+    // the storage needs one byte more than the buffer size
+    message_buffer = xMessageBufferCreateStatic(receive_msg_buffer_size,
+                                                message_buffer_storage,
+                                                &message_buffer_struct);
+  } else {
+    message_buffer = xMessageBufferCreate(receive_msg_buffer_size);
+  }
+  return message_buffer != nullptr;
+}
+
+// Internal: Software filter for a shared radio: accepts the frames to our
+// PAN and address, broadcasts and frames without destination
+bool ESP32TransceiverIEEE802_15_4::acceptsFrame(const FrameView& view) {
+  if (is_promiscuous_mode) return true;
+  if (!view.isValid()) return false;
+  uint8_t len = view.destAddrLen();
+  if (len == 0) return true;
+  uint16_t pan = view.destPanId();
+  if (pan != 0xFFFF && pan != (uint16_t)panID) return false;
+  const uint8_t* dest = view.destAddress();
+  if (len == 2 && dest[0] == 0xFF && dest[1] == 0xFF) return true;
+  return len == local_address.length() &&
+         memcmp(dest, local_address.data(), len) == 0;
+}
 
-  // Handle receive done to free internal buffers
-  if (esp_ieee802154_receive_handle_done(frame) != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to handle receive done");
+// Internal: Copies the received frame into the frame pool or the RX message
+// buffer. Called by the RadioDispatcher from the ISR.
+void ESP32TransceiverIEEE802_15_4::receiveFromISR(
+    uint8_t* frame, esp_ieee802154_frame_info_t* frame_info,
+    uint32_t rx_time_us, BaseType_t* task_woken) {
+  if (p_channel_hopper) p_channel_hopper->onReceive(*frame_info);
+
+  if (frame_pool_semaphore) {
+    // Copy the frame directly into a free slot
+    frame_data_t* slot = frame_pool.acquire();
+    if (slot == nullptr) {
+      // no logging in the ISR: the drop is counted in the statistics
+      stats.addRxDropped();
+      return;
+    }
+    size_t len = frame[0] < MAX_FRAME_LEN ? frame[0] : MAX_FRAME_LEN - 1;
+    memcpy(slot->frame, frame, len + 1);
+    slot->frame[0] = len;
+    slot->frame_info = *frame_info;
+    slot->rx_time_us = rx_time_us;
+
+    // Hand over the slot to the consumer
+    frame_pool.publish(slot);
+    xSemaphoreGiveFromISR(frame_pool_semaphore, task_woken);
+    stats.addRx(len);
+    return;
   }
 
   if (!message_buffer) {
-    ESP_LOGE(TAG, "Message buffer not initialized, dropping packet");
+    stats.addRxDropped();
     return;
   }
 
-  // Add data to message buffer
-  int len = sizeof(frame_data_t);
-  BaseType_t higher_priority_task_woken = pdFALSE;
-  size_t bytes_sent = xMessageBufferSendFromISR(message_buffer, &packet, len,
-                                                &higher_priority_task_woken);
-
+  // Add compact record to message buffer
+  frame_record_t record;
+  record.set(frame, *frame_info, rx_time_us);
+  size_t len = record.size();
+  size_t bytes_sent =
+      xMessageBufferSendFromISR(message_buffer, &record, len, task_woken);
   if (bytes_sent != len) {
-    ESP_LOGW(TAG, "Message buffer write error %d bytes sent, expected %d", bytes_sent, len);
-  }
-
-  if (higher_priority_task_woken) {
-    portYIELD_FROM_ISR(higher_priority_task_woken);
+    stats.addRxDropped();
+  } else {
+    stats.addRx(record.frame[0]);
   }
 }
 
@@ -361,15 +573,17 @@ bool ESP32TransceiverIEEE802_15_4::setSfdTxCallback(
 void ESP32TransceiverIEEE802_15_4::onTransmitDone(
     const uint8_t* frame, const uint8_t* ack,
     esp_ieee802154_frame_info_t* ack_frame_info) {
+  if (p_tx_power_controller && ack && ack_frame_info) {
+    p_tx_power_controller->onAck(frame, *ack_frame_info);
+  }
   if (tx_done_callback_) {
     tx_done_callback_(frame, ack, ack_frame_info, tx_done_callback_user_data_);
   }
-  // Free internal buffers after transmission
-  esp_ieee802154_receive_handle_done(ack);  
 }
 
 void ESP32TransceiverIEEE802_15_4::onTransmitFailed(
     const uint8_t* frame, esp_ieee802154_tx_error_t error) {
+  if (p_tx_power_controller) p_tx_power_controller->onFailure(frame, error);
   if (tx_failed_callback_) {
     tx_failed_callback_(frame, error, tx_failed_callback_user_data_);
   }
@@ -388,9 +602,60 @@ void ESP32TransceiverIEEE802_15_4::onStartFrameDelimiterTransmitDone(
   }
 }
 
+frame_data_t* ESP32TransceiverIEEE802_15_4::receiveFrame(TickType_t wait) {
+  if (frame_pool_semaphore) {
+    // The semaphore can still be given for a frame that was already taken
+    // from the pool: wait again until a frame arrives or the time is up
+    TickType_t start = xTaskGetTickCount();
+    while (true) {
+      frame_data_t* slot = frame_pool.receive();
+      if (slot != nullptr) return slot;
+      TickType_t remaining = portMAX_DELAY;
+      if (wait != portMAX_DELAY) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= wait) return nullptr;
+        remaining = wait - elapsed;
+      }
+      if (xSemaphoreTake(frame_pool_semaphore, remaining) != pdTRUE) {
+        return frame_pool.receive();
+      }
+    }
+  }
+  return readFrame(rx_packet, wait) ? &rx_packet : nullptr;
+}
+
+void ESP32TransceiverIEEE802_15_4::releaseFrame(frame_data_t* packet) {
+  if (frame_pool_semaphore && packet != &rx_packet) {
+    frame_pool.release(packet);
+  }
+}
+
+bool ESP32TransceiverIEEE802_15_4::readFrame(frame_data_t& packet,
+                                             TickType_t wait) {
+  if (frame_pool_semaphore) {
+    frame_data_t* slot = receiveFrame(wait);
+    if (slot == nullptr) return false;
+    packet = *slot;
+    releaseFrame(slot);
+    return true;
+  }
+  if (!message_buffer) return false;
+  frame_record_t record;
+  size_t read_bytes =
+      xMessageBufferReceive(message_buffer, &record, sizeof(record), wait);
+  if (read_bytes == 0) return false;
+  if (read_bytes < frame_record_t::HEADER_SIZE + 1 ||
+      read_bytes != record.size()) {
+    ESP_LOGE(TAG, "Invalid packet size received: %d", read_bytes);
+    stats.addRxParseError();
+    return false;
+  }
+  record.get(packet);
+  return true;
+}
+
 void ESP32TransceiverIEEE802_15_4::default_receive_packet_task(
     void* pvParameters) {
-  frame_data_t packet;
   Frame frame{};
   ESP32TransceiverIEEE802_15_4& transceiver =
       *static_cast<ESP32TransceiverIEEE802_15_4*>(pvParameters);
@@ -398,33 +663,109 @@ void ESP32TransceiverIEEE802_15_4::default_receive_packet_task(
   ESP_LOGI(TAG, "Receive packet task started");
 
   while (1) {
-    // Receive packet from message buffer
-    size_t read_bytes =
-        xMessageBufferReceive(transceiver.message_buffer, &packet,
-                              sizeof(frame_data_t), pdMS_TO_TICKS(10));
-    if (read_bytes != sizeof(frame_data_t)) {
-      if (read_bytes != 0) {
-        ESP_LOGE(TAG, "Invalid packet size received: %d", read_bytes);
-      }
+    // Deliver frames in batches
+    if (transceiver.rx_batch_callback_) {
+      transceiver.processBatch();
       continue;
     }
 
+    // Block until a frame is available
+    frame_data_t* packet = transceiver.receiveFrame(portMAX_DELAY);
+
+    // Drain all queued frames without sleeping
+    while (packet != nullptr) {
+      transceiver.processFrame(frame, packet);
+      packet = transceiver.receiveFrame(0);
+    }
+  }
+}
+
+void ESP32TransceiverIEEE802_15_4::processFrame(Frame& frame,
+                                                frame_data_t* packet) {
+  uint32_t dequeue_us = p_latency_metrics ? esp_timer_get_time() : 0;
+
+  // Parse frame
+  if (!frame.parse(packet->frame, false)) {
+    ESP_LOGE(TAG, "Failed to parse frame");
+    stats.addRxParseError();
+    releaseFrame(packet);
+    return;
+  }
+
+  // Invoke callback if set
+  if (rx_callback_) {
+    uint32_t start_us = esp_timer_get_time();
+    rx_latency.add(start_us - packet->rx_time_us);
+    rx_callback_(frame, packet->frame_info, rx_callback_user_data_);
+    if (p_latency_metrics) {
+      p_latency_metrics->add(packet->frame_info.timestamp, packet->rx_time_us,
+                             dequeue_us, start_us, esp_timer_get_time());
+    }
+  }
+  releaseFrame(packet);
+}
+
+void ESP32TransceiverIEEE802_15_4::processBatch() {
+  size_t count = 0;
+  size_t received = 0;
+  TickType_t start = 0;
+  TickType_t wait = portMAX_DELAY;  // block until the first frame arrives
+  if (!frame_pool_semaphore) {
+    rx_batch_storage.resize(rx_batch_frames.size());
+  }
+  while (count < rx_batch_frames.size()) {
+    // Get next frame: the data must stay valid until the callback returns
+    frame_data_t* packet = nullptr;
+    if (frame_pool_semaphore) {
+      packet = receiveFrame(wait);
+    } else if (readFrame(rx_batch_storage[count], wait)) {
+      packet = &rx_batch_storage[count];
+    }
+    if (packet == nullptr) {
+      if (received == 0) continue;  // spurious wakeup
+      break;
+    }
+    if (received++ == 0) start = xTaskGetTickCount();
+    if (p_latency_metrics) rx_batch_dequeue_us[count] = esp_timer_get_time();
+
     // Parse frame
-    if (!frame.parse(packet.frame, false)) {
+    if (rx_batch_frames[count].parse(packet->frame, false)) {
+      rx_batch_packets[count] = packet;
+      rx_batch_infos[count] = packet->frame_info;
+      count++;
+    } else {
       ESP_LOGE(TAG, "Failed to parse frame");
-      continue;
+      stats.addRxParseError();
+      releaseFrame(packet);
     }
 
-    // Invoke callback if set
-    ESP32TransceiverIEEE802_15_4* self = pt_transceiver;
-    if (self && self->rx_callback_) {
-      // self->frame = frame;  // Update frame info for callback
-      self->rx_callback_(frame, packet.frame_info,
-                         self->rx_callback_user_data_);
+    // Wait for more frames only within the latency bound
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    wait = elapsed < rx_batch_max_latency ? rx_batch_max_latency - elapsed : 0;
+  }
+
+  // Invoke batch callback
+  if (count > 0 && rx_batch_callback_) {
+    uint32_t now = esp_timer_get_time();
+    for (size_t j = 0; j < count; j++) {
+      rx_latency.add(now - rx_batch_packets[j]->rx_time_us);
+    }
+    rx_batch_callback_(rx_batch_frames.data(), rx_batch_infos.data(), count,
+                       rx_batch_callback_user_data_);
+    if (p_latency_metrics) {
+      uint32_t end = esp_timer_get_time();
+      for (size_t j = 0; j < count; j++) {
+        frame_data_t* packet = rx_batch_packets[j];
+        p_latency_metrics->add(packet->frame_info.timestamp,
+                               packet->rx_time_us, rx_batch_dequeue_us[j], now,
+                               end);
+      }
     }
+  }
 
-    // Short delay to yield CPU
-    delay(1);
+  // Release all frames of the batch
+  for (size_t j = 0; j < count; j++) {
+    releaseFrame(rx_batch_packets[j]);
   }
 }
 
@@ -462,42 +803,10 @@ bool ESP32TransceiverIEEE802_15_4::setTxPower(int power) {
     ESP_LOGE(TAG, "Failed to set transmit power to %d", power);
     return false;
   }
+  // used for the frames without power control
+  RadioDispatcher& radio = RadioDispatcher::instance();
+  radio.base_tx_power = radio.radio_tx_power = power;
   return true;
 }
 
 }  // namespace ieee802154
-
-// The SFD (Start Frame Delimiter) of the frame was received.
-extern "C" void esp_ieee802154_receive_sfd_done(void) {
-  ESP_LOGD(TAG, "esp_ieee802154_receive_sfd_done");
-  if (pt_transceiver) pt_transceiver->onStartFrameDelimiterReceived();
-}
-
-// Callback for received IEEE 802.15.4 frames.
-extern "C" void esp_ieee802154_receive_done(
-    uint8_t* frame, esp_ieee802154_frame_info_t* frame_info) {
-  ESP_LOGD(TAG, "esp_ieee802154_receive_done");
-  if (pt_transceiver) pt_transceiver->onRxDone(frame, frame_info);
-}
-
-// The Frame Transmission succeeded.
-extern "C" void esp_ieee802154_transmit_done(
-    const uint8_t* frame, const uint8_t* ack,
-    esp_ieee802154_frame_info_t* ack_frame_info) {
-  ESP_LOGD(TAG, "esp_ieee802154_transmit_done");
-  if (pt_transceiver)
-    pt_transceiver->onTransmitDone(frame, ack, ack_frame_info);
-}
-
-// The Frame Transmission failed.
-extern "C" void esp_ieee802154_transmit_failed(
-    const uint8_t* frame, esp_ieee802154_tx_error_t error) {
-  ESP_LOGD(TAG, "esp_ieee802154_transmit_failed");
-  if (pt_transceiver) pt_transceiver->onTransmitFailed(frame, error);
-}
-
-// The SFD field of the frame was transmitted.
-extern "C" void esp_ieee802154_transmit_sfd_done(uint8_t* frame) {
-  ESP_LOGD(TAG, "esp_ieee802154_transmit_sfd_done");
-  if (pt_transceiver) pt_transceiver->onStartFrameDelimiterTransmitDone(frame);
-}
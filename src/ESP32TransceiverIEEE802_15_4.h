@@ -8,18 +8,30 @@
 #include <esp_log.h>
 #include <stdint.h>
 
+#include <array>
+
 #include "Frame.h"  // From shoderico/ieee802154_frame
+#include "FrameFilter.h"
+#include "FrameLayout.h"
+#include "FramePool.h"
+#include "FrameView.h"
+#include "LatencyMetrics.h"
+#include "RadioDispatcher.h"
+#include "TransceiverStatistics.h"
+#include "TxPowerController.h"
 #include "esp_err.h"
 #include "esp_ieee802154.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/message_buffer.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "nvs_flash.h"
 
 namespace ieee802154 {
 
 // forward declaration
-class ESP32TransceiverIEEE802_15_4;
-extern ESP32TransceiverIEEE802_15_4* pt_transceiver;
+class ChannelHopper;
 
 /**
  * @brief Enum for IEEE 802.15.4 channel numbers (11-26).
@@ -54,6 +66,18 @@ enum class channel_t : uint8_t {
 typedef void (*ieee802154_transceiver_rx_callback_t)(
     Frame& frame, esp_ieee802154_frame_info_t& frame_info, void* user_data);
 
+/**
+ * @brief Callback function type for batches of received IEEE 802.15.4 frames.
+ *
+ * @param frames Array of parsed IEEE 802.15.4 frames.
+ * @param frame_infos Array with the frame information of each frame.
+ * @param count Number of frames in the arrays.
+ * @param user_data User-defined data passed to the callback.
+ */
+typedef void (*ieee802154_transceiver_rx_batch_callback_t)(
+    Frame* frames, esp_ieee802154_frame_info_t* frame_infos, size_t count,
+    void* user_data);
+
 /**
  * @brief Callback function type for successful IEEE 802.15.4 frame
  * transmission.
@@ -77,6 +101,16 @@ typedef void (*ieee802154_transceiver_tx_done_callback_t)(
 typedef void (*ieee802154_transceiver_tx_failed_callback_t)(
     const uint8_t* frame, esp_ieee802154_tx_error_t error, void* user_data);
 
+/**
+ * @brief Callback function type for the completion of a queued transmission.
+ *
+ * @param token Token that was returned by sendAsync().
+ * @param error ESP_IEEE802154_TX_ERR_NONE on success, otherwise the error.
+ * @param user_data User-defined data passed to the callback.
+ */
+typedef void (*ieee802154_transceiver_tx_complete_callback_t)(
+    uint32_t token, esp_ieee802154_tx_error_t error, void* user_data);
+
 /**
  * @brief Callback function type for SFD (Start Frame Delimiter) received event.
  *
@@ -92,6 +126,75 @@ typedef void (*ieee802154_transceiver_sfd_callback_t)(void* user_data);
  */
 typedef void (*ieee802154_transceiver_sfd_tx_callback_t)(uint8_t* frame,
                                                          void* user_data);
+/**
+ * @brief Latency statistics from esp_ieee802154_receive_done to the start of
+ * the rx callback in microseconds.
+ */
+struct rx_latency_t {
+  uint32_t count = 0;     // Number of measured frames
+  uint32_t last_us = 0;   // Latency of the last frame
+  uint32_t min_us = 0;    // Minimum latency
+  uint32_t max_us = 0;    // Maximum latency
+  uint64_t total_us = 0;  // Sum of all latencies
+
+  /// Average latency in microseconds
+  uint32_t avgUs() const { return count == 0 ? 0 : total_us / count; }
+
+  /// Adds a measured latency
+  void add(uint32_t latency_us) {
+    if (count == 0 || latency_us < min_us) min_us = latency_us;
+    if (latency_us > max_us) max_us = latency_us;
+    last_us = latency_us;
+    total_us += latency_us;
+    count++;
+  }
+};
+
+/**
+ * @brief Entry of the TX queue: a built frame and its completion token.
+ */
+struct tx_slot_t {
+  uint8_t frame[MAX_FRAME_LEN];  // Frame with length byte
+  uint32_t token = 0;            // Completion token
+  int8_t tx_power = TX_POWER_UNCHANGED;  // TX power of the frame in dBm
+};
+
+/**
+ * @brief Part of the payload for the scatter-gather send: the segments are
+ * copied one after the other into the frame.
+ */
+struct tx_segment_t {
+  const uint8_t* data;  // Segment data
+  size_t len;           // Segment length
+};
+
+/**
+ * @brief Configuration of a receive task: by default it is not pinned to a
+ * core and its stack is allocated from the heap.
+ */
+struct rx_task_config_t {
+  const char* name = "RX";           // Task name
+  uint32_t stack_size = 1024 * 5;    // Stack size in bytes
+  UBaseType_t priority = 5;          // Task priority
+  BaseType_t core = tskNO_AFFINITY;  // Core or tskNO_AFFINITY
+  StackType_t* stack = nullptr;      // Optional stack with stack_size bytes
+
+  /// Creates the task: uses the static stack if it has been provided
+  TaskHandle_t create(TaskFunction_t task, void* arg,
+                      StaticTask_t* task_buffer) const {
+    if (stack != nullptr) {
+      return xTaskCreateStaticPinnedToCore(task, name, stack_size, arg,
+                                           priority, stack, task_buffer, core);
+    }
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(task, name, stack_size, arg, priority, &handle,
+                                core) != pdPASS) {
+      return nullptr;
+    }
+    return handle;
+  }
+};
+
 /// Broadcast address constant
 inline Address BROADCAST_ADDRESS((uint8_t[2]){0xFF, 0xFF});
 
@@ -101,23 +204,16 @@ inline Address BROADCAST_ADDRESS((uint8_t[2]){0xFF, 0xFF});
  * On the receiving side we support promiscuous mode, and reveiving only frames
  * that are destinated to the device or broadcast frames.
  *
- * @warning Only one instance of this class should be created, as the ESP-IDF
- * callbacks are global and will reference the single instance through a global
- * pointer. Creating multiple instances may lead to undefined behavior.
+ * Several instances can share the radio, e.g. a sniffer and a data endpoint:
+ * the ESP-IDF callbacks are global and are routed to the active instances by
+ * the RadioDispatcher. All instances use the channel of the radio.
  */
 
 class ESP32TransceiverIEEE802_15_4 {
-  // Friend declarations for global callback functions
+  // Friend declarations for the routing of the global callback functions
   friend void receive_packet_task(void*);
-  friend void ::esp_ieee802154_receive_done(
-      uint8_t* frame, esp_ieee802154_frame_info_t* frame_info);
-  friend void ::esp_ieee802154_transmit_done(
-      const uint8_t* frame, const uint8_t* ack,
-      esp_ieee802154_frame_info_t* ack_frame_info);
-  friend void ::esp_ieee802154_transmit_failed(const uint8_t* frame,
-                                               esp_ieee802154_tx_error_t error);
-  friend void ::esp_ieee802154_receive_sfd_done(void);
-  friend void ::esp_ieee802154_transmit_sfd_done(uint8_t* frame);
+  friend class RadioDispatcher;
+  friend class ChannelHopper;
 
  public:
   /**
@@ -131,7 +227,14 @@ class ESP32TransceiverIEEE802_15_4 {
     this->channel = channel;
     this->panID = panID;
     this->local_address = localAddress;
-    pt_transceiver = this;
+  }
+
+  /**
+   * @brief Destroy the ESP32TransceiverIEEE802_15_4 object: it is removed
+   * from the radio.
+   */
+  ~ESP32TransceiverIEEE802_15_4() {
+    if (radio_enabled) end();
   }
 
   /**
@@ -153,6 +256,18 @@ class ESP32TransceiverIEEE802_15_4 {
     return begin();
   }
 
+  /**
+   * @brief Initialize the IEEE 802.15.4 transceiver with a specific
+   * configuration of the receive task (core, priority and stack).
+   * @param config The receive task configuration.
+   *
+   * @return ESP_OK on success, or an error code on failure.
+   */
+  bool begin(const rx_task_config_t& config) {
+    setReceiveTaskConfig(config);
+    return begin();
+  }
+
   /**
    * @brief Deinitialize the IEEE 802.15.4 transceiver.
    *
@@ -170,6 +285,26 @@ class ESP32TransceiverIEEE802_15_4 {
   bool setRxCallback(ieee802154_transceiver_rx_callback_t callback,
                      void* user_data);
 
+  /**
+   * @brief Set the callback function for batches of received frames. The
+   * receive task collects all frames that are available when it wakes up and
+   * provides them with a single call. If a batch callback is defined, it is
+   * used instead of the rx callback.
+   *
+   * @param callback Callback function to invoke with the received frames.
+   * @param user_data User-defined data to pass to the callback.
+   * @param max_batch_size Maximum number of frames per call.
+   * @param max_latency_ms Maximum time to wait for additional frames after the
+   * first frame of a batch was received (0 = deliver what is available).
+   * @return True on success.
+   * @note When the frame pool is active, it must provide more slots than the
+   * batch size because the slots are only released after the callback.
+   * @note This method must be called before begin() to take effect!
+   */
+  bool setRxBatchCallback(ieee802154_transceiver_rx_batch_callback_t callback,
+                          void* user_data, size_t max_batch_size = 16,
+                          uint32_t max_latency_ms = 0);
+
   /**
    * @brief Set the callback function for successful frame transmission.
    *
@@ -192,6 +327,18 @@ class ESP32TransceiverIEEE802_15_4 {
   bool setTxFailedCallback(ieee802154_transceiver_tx_failed_callback_t callback,
                            void* user_data);
 
+  /**
+   * @brief Set the callback function that reports the completion of each
+   * queued transmission by its token.
+   *
+   * @param callback Callback function to invoke when a queued frame was
+   * transmitted or failed.
+   * @param user_data User-defined data to pass to the callback.
+   * @return True on success.
+   */
+  bool setTxCompleteCallback(
+      ieee802154_transceiver_tx_complete_callback_t callback, void* user_data);
+
   /**
    * @brief Set the callback function for SFD (Start Frame Delimiter) received
    * event.
@@ -219,7 +366,55 @@ class ESP32TransceiverIEEE802_15_4 {
    * @param len length of the payload data.
    * @return ESP_OK on success, or an error code on failure.
    */
-  bool send(uint8_t* data, size_t len);
+  bool send(uint8_t* data, size_t len) { return sendAsync(data, len) != 0; }
+
+  /**
+   * @brief Queue an IEEE 802.15.4 frame for transmission on the current
+   * channel. The frame is built immediately and transmitted as soon as the
+   * radio is free. The TX queue has a single producer: the frames must not be
+   * sent from several tasks at the same time.
+   *
+   * @param data payload data to tramsit.
+   * @param len length of the payload data.
+   * @return Token to identify the transmission in the tx complete callback or
+   * 0 if the frame could not be queued.
+   */
+  uint32_t sendAsync(uint8_t* data, size_t len);
+
+  /**
+   * @brief Transmit an IEEE 802.15.4 frame with a payload that is made up of
+   * several segments (e.g. an application header and a body). Each segment is
+   * copied only once directly into the radio buffer.
+   *
+   * @param segments The payload segments.
+   * @param count Number of segments.
+   * @return True on success, false on failure.
+   */
+  bool send(const tx_segment_t* segments, size_t count) {
+    return sendAsync(segments, count) != 0;
+  }
+
+  /**
+   * @brief Transmit an IEEE 802.15.4 frame with a payload that is made up of
+   * several segments: e.g. send({{header, 4}, {body, len}}).
+   *
+   * @tparam N Number of segments.
+   * @param segments The payload segments.
+   * @return True on success, false on failure.
+   */
+  template <size_t N>
+  bool send(const tx_segment_t (&segments)[N]) {
+    return sendAsync(segments, N) != 0;
+  }
+
+  /**
+   * @brief Queue an IEEE 802.15.4 frame with a payload that is made up of
+   * several segments. See send(const tx_segment_t*, size_t).
+   *
+   * @return Token to identify the transmission in the tx complete callback or
+   * 0 if the frame could not be queued.
+   */
+  uint32_t sendAsync(const tx_segment_t* segments, size_t count);
 
   /**
    * @brief Transmit an IEEE 802.15.4 frame. You need to setup up
@@ -231,7 +426,86 @@ class ESP32TransceiverIEEE802_15_4 {
    * @note if the the frame frame does not have a PAN, source or destination
    * address, we will use the information defined in the transceiver object.
    */
-  bool send(Frame& frame);
+  bool send(Frame& frame) { return sendAsync(frame) != 0; }
+
+  /**
+   * @brief Queue an IEEE 802.15.4 frame for transmission. See send(Frame&).
+   *
+   * @param frame The frame to transmit.
+   * @return Token to identify the transmission in the tx complete callback or
+   * 0 if the frame could not be queued.
+   */
+  uint32_t sendAsync(Frame& frame);
+
+  /**
+   * @brief Transmit the payload with a fixed header that is described by a
+   * FrameLayout. Only the sequence number and the payload are written per
+   * frame.
+   *
+   * @param layout The header description with PAN and addresses.
+   * @param data payload data to tramsit.
+   * @param len length of the payload data.
+   * @return True on success, false on failure.
+   */
+  template <typename Layout>
+  bool send(const Layout& layout, const uint8_t* data, size_t len) {
+    return sendAsync(layout, data, len) != 0;
+  }
+
+  /**
+   * @brief Queue the payload with a fixed header that is described by a
+   * FrameLayout. See send(const Layout&, const uint8_t*, size_t).
+   *
+   * @return Token to identify the transmission in the tx complete callback or
+   * 0 if the frame could not be queued.
+   */
+  template <typename Layout>
+  uint32_t sendAsync(const Layout& layout, const uint8_t* data, size_t len) {
+    tx_slot_t* slot = beginTxSlot();
+    if (slot == nullptr) return 0;
+    return endTxSlot(slot, layout.build(slot->frame, frame.sequenceNumber,
+                                        data, len));
+  }
+
+  /**
+   * @brief Defines the number of frames that can be queued for transmission.
+   * @param size Number of TX queue entries.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setTxQueueSize(int size) {
+    if (size > 0 && tx_queue_storage == nullptr) tx_queue_size = size;
+  }
+
+  /**
+   * @brief Provides the memory for the TX queue, so that begin() does not
+   * allocate it.
+   * @param slots Memory for the queue entries.
+   * @param count Number of entries.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setTxQueueStorage(tx_slot_t* slots, size_t count) {
+    tx_queue_storage = slots;
+    tx_queue_size = count;
+  }
+
+  /**
+   * @brief Get the number of frames that can be queued for transmission.
+   * @return The size of the TX queue.
+   */
+  int getTxQueueSize() const { return tx_queue_size; }
+
+  /**
+   * @brief Get the number of free entries in the TX queue.
+   * @return Number of frames that can be queued without blocking.
+   */
+  int getTxQueueAvailable() const { return tx_queue_len - tx_count; }
+
+  /**
+   * @brief Get the maximum payload of send(uint8_t*, size_t) for the current
+   * frame control field and addresses.
+   * @return Payload size in bytes.
+   */
+  size_t getMaxPayloadSize();
 
   /**
    * @brief Change the IEEE 802.15.4 channel.
@@ -316,6 +590,7 @@ class ESP32TransceiverIEEE802_15_4 {
    */
   void setDestinationAddress(const Address& address) {
     destination_address = address;
+    tx_header_valid = false;
   }
 
   /**
@@ -330,6 +605,7 @@ class ESP32TransceiverIEEE802_15_4 {
    */
   void setFrameControlField(const FrameControlField& fcf) {
     frame_control_field = fcf;
+    tx_header_valid = false;
   }
 
   /**
@@ -357,16 +633,208 @@ class ESP32TransceiverIEEE802_15_4 {
 
   /***
    * @brief Defines the receive buffer size for incoming frames.
+   * Each frame needs frame_record_t::HEADER_SIZE + frame length + 5 bytes.
    * @param size The size of the receive buffer in bytes.
    * @note This method must be called before begin() to take effect!
    */
   void setReceiveBufferSize(int size);
+
+  /**
+   * @brief Get the receive buffer size for incoming frames.
+   * @return The size of the receive buffer in bytes.
+   */
+  int getReceiveBufferSize() const { return receive_msg_buffer_size; }
+
+  /**
+   * @brief Provides the memory for the receive buffer, so that begin() does not
+   * allocate it. The receive buffer size is set to size - 1.
+   * @param storage Memory for the message buffer.
+   * @param size Size of the memory in bytes: the receive buffer must hold at
+   * least one frame, so the minimum is sizeof(frame_record_t) + 5.
+   * @return False if the memory is too small.
+   * @note This method must be called before begin() to take effect!
+   */
+  bool setReceiveBufferStorage(uint8_t* storage, size_t size);
+
+  /**
+   * @brief Provides the stack for the receive task, so that begin() creates
+   * it with xTaskCreateStatic().
+   * @param stack Memory for the stack.
+   * @param size Stack size in bytes (StackType_t is a byte on the ESP32).
+   * @note This method must be called before begin() to take effect!
+   */
+  void setReceiveTaskStack(StackType_t* stack, uint32_t size) {
+    rx_task_config.stack = stack;
+    rx_task_config.stack_size = size;
+  }
+
+  /**
+   * @brief Defines the core, priority and stack of the receive task.
+   * @param config The receive task configuration.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setReceiveTaskConfig(const rx_task_config_t& config) {
+    rx_task_config = config;
+  }
+
+  /**
+   * @brief Get the configuration of the receive task.
+   * @return The receive task configuration.
+   */
+  const rx_task_config_t& getReceiveTaskConfig() const {
+    return rx_task_config;
+  }
+
+  /**
+   * @brief Get the minimum free stack of the receive task since it was
+   * started: use it to trim the stack size.
+   * @return The free stack in bytes or 0 if the task is not running.
+   */
+  uint32_t getReceiveTaskStackHighWaterMark() const {
+    if (rx_task_handle == nullptr) return 0;
+    return uxTaskGetStackHighWaterMark(rx_task_handle);
+  }
   /**
    * @brief Get the FreeRTOS message buffer handle for received frames.
    * @return StreamBufferHandle_t for the RX message buffer.
    */
   StreamBufferHandle_t getMessageBuffer() const { return message_buffer; }
 
+  /**
+   * @brief Read the next received frame from the RX message buffer.
+   * The frames are stored in the compact frame_record_t format, so that small
+   * frames only use the space they need.
+   * @param packet Destination for the frame data and frame info.
+   * @param wait Maximum time to wait for a frame in ticks.
+   * @return True if a frame was read, false on timeout or error.
+   */
+  bool readFrame(frame_data_t& packet, TickType_t wait);
+
+  /**
+   * @brief Get the next received frame without copying it. When the frame pool
+   * is active, the slot that was filled by the ISR is returned directly.
+   * @param wait Maximum time to wait for a frame in ticks.
+   * @return Pointer to the frame data or nullptr on timeout. The frame must be
+   * given back with releaseFrame() after processing.
+   */
+  frame_data_t* receiveFrame(TickType_t wait);
+
+  /**
+   * @brief Release a frame that was provided by receiveFrame().
+   * @param packet The frame data to release.
+   */
+  void releaseFrame(frame_data_t* packet);
+
+  /**
+   * @brief Defines the number of pre-allocated frame slots that are used to
+   * pass the received frames from the ISR to the consumer without copying.
+   * If the size is 0 (default) the RX message buffer is used instead.
+   * @param count Number of frame slots.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setFramePoolSize(int count) { frame_pool_size = count; }
+
+  /**
+   * @brief Get the number of frame slots of the frame pool.
+   * @return The number of frame slots (0 if the pool is not used).
+   */
+  int getFramePoolSize() const { return frame_pool_size; }
+
+  /**
+   * @brief Defines a filter that is evaluated on the raw frame in the receive
+   * ISR: frames that it rejects are dropped before they are queued. This is
+   * useful in promiscuous mode to reduce the load on the receive task.
+   * @param filter The filter or nullptr to receive all frames.
+   * @note The filter must not be changed while the transceiver is active!
+   */
+  void setFrameFilter(FrameFilter* filter) { p_frame_filter = filter; }
+
+  /**
+   * @brief Get the filter that is evaluated in the receive ISR.
+   * @return The filter or nullptr if all frames are received.
+   */
+  FrameFilter* getFrameFilter() const { return p_frame_filter; }
+
+  /**
+   * @brief Provides the memory for the frame pool, so that begin() does not
+   * allocate it. This also sets the frame pool size.
+   * @param frames Memory for count frame slots.
+   * @param indexes Memory for 2 * (count + 1) slot indexes.
+   * @param count Number of frame slots.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setFramePoolStorage(frame_data_t* frames, uint16_t* indexes,
+                           size_t count) {
+    frame_pool.setStorage(frames, indexes, count);
+    frame_pool_size = count;
+  }
+
+  /**
+   * @brief Get the latency statistics from the reception of a frame by the
+   * radio driver to the call of the rx callback in the receive task.
+   * @return The latency statistics.
+   */
+  rx_latency_t getRxLatency() const { return rx_latency; }
+
+  /**
+   * @brief Reset the latency statistics.
+   */
+  void resetRxLatency() { rx_latency = rx_latency_t{}; }
+
+  /**
+   * @brief Records the latencies of each frame that is delivered by the
+   * receive task into histograms: from the radio timestamp over the queueing
+   * in the ISR and the dequeue by the task to the start and end of the rx
+   * (batch) callback. The metrics are not updated by a custom receive task.
+   * @param metrics Histograms to update or nullptr to stop the recording.
+   */
+  void setLatencyMetrics(LatencyMetrics* metrics) {
+    p_latency_metrics = metrics;
+  }
+
+  /**
+   * @brief Get the latency histograms that are updated by the receive task.
+   * @return The metrics or nullptr if no latencies are recorded.
+   */
+  LatencyMetrics* getLatencyMetrics() const { return p_latency_metrics; }
+
+  /**
+   * @brief Sends each frame with the TX power that is determined by the
+   * controller for its destination: the controller is updated with the ACKs
+   * and the failed transmissions. Broadcast frames and the frames that are
+   * queued without controller are sent with the power of setTxPower().
+   * @param controller Power controller or nullptr to use a fixed power.
+   */
+  void setTxPowerController(TxPowerController* controller) {
+    p_tx_power_controller = controller;
+  }
+
+  /**
+   * @brief Get the TX power controller.
+   * @return The controller or nullptr if a fixed power is used.
+   */
+  TxPowerController* getTxPowerController() const {
+    return p_tx_power_controller;
+  }
+
+  /**
+   * @brief Get a consistent snapshot of the RX and TX statistics.
+   * @return Copy of all counters.
+   */
+  transceiver_stats_t getStatistics() const { return stats.snapshot(); }
+
+  /**
+   * @brief Get the statistics counters, e.g. to count the retransmissions of
+   * a protocol on top of the transceiver.
+   * @return The counters.
+   */
+  TransceiverStatistics& statistics() { return stats; }
+
+  /**
+   * @brief Reset the statistics counters.
+   */
+  void resetStatistics() { stats.reset(); }
+
   /**
    * @brief Increment the sequence number in the current frame by a
    * specified value.
@@ -430,16 +898,56 @@ class ESP32TransceiverIEEE802_15_4 {
   Address local_address;  // Local address for filtering (0, 2, or 8 bytes)
   Address destination_address = BROADCAST_ADDRESS;
   FrameControlField frame_control_field{};
-  uint8_t transmit_buffer[MAX_FRAME_LEN] = {0};
+  // prebuilt header for send(uint8_t*, size_t)
+  uint8_t tx_header[32];
+  size_t tx_header_len = 0;
+  FrameControlField tx_header_fcf{};  // FCF used for tx_header
+  bool tx_header_valid = false;
+  tx_slot_t* tx_queue = nullptr;
+  size_t tx_queue_len = 0;
+  std::vector<tx_slot_t> tx_queue_buffer;  // used w/o external storage
+  tx_slot_t* tx_queue_storage = nullptr;   // external storage
+  int tx_queue_size = 4;
+  size_t tx_head = 0;
+  size_t tx_tail = 0;
+  std::atomic<size_t> tx_count{0};
+  uint32_t tx_next_token = 0;
   StreamBufferHandle_t message_buffer = nullptr;
+  uint8_t* message_buffer_storage = nullptr;  // external storage
+  size_t message_buffer_storage_size = 0;
+  StaticMessageBuffer_t message_buffer_struct;
+  FramePool frame_pool;
+  FrameFilter* p_frame_filter = nullptr;
+  int frame_pool_size = 0;
+  SemaphoreHandle_t frame_pool_semaphore = nullptr;
+  StaticSemaphore_t frame_pool_semaphore_buffer;
+  frame_data_t rx_packet;  // used by receiveFrame() w/o frame pool
+  rx_latency_t rx_latency;
+  LatencyMetrics* p_latency_metrics = nullptr;
+  TxPowerController* p_tx_power_controller = nullptr;
+  TransceiverStatistics stats;
+  ChannelHopper* p_channel_hopper = nullptr;  // set while hopping
   TaskHandle_t rx_task_handle = nullptr;
-  bool radio_enabled = false;
+  rx_task_config_t rx_task_config;
+  StaticTask_t rx_task_buffer;
+  bool radio_enabled = false;  // registered at the RadioDispatcher
   ieee802154_transceiver_rx_callback_t rx_callback_ = nullptr;
   void* rx_callback_user_data_ = nullptr;
+  ieee802154_transceiver_rx_batch_callback_t rx_batch_callback_ = nullptr;
+  void* rx_batch_callback_user_data_ = nullptr;
+  TickType_t rx_batch_max_latency = 0;
+  std::vector<Frame> rx_batch_frames;
+  std::vector<esp_ieee802154_frame_info_t> rx_batch_infos;
+  std::vector<frame_data_t*> rx_batch_packets;
+  std::vector<uint32_t> rx_batch_dequeue_us;
+  std::vector<frame_data_t> rx_batch_storage;  // used w/o frame pool
   ieee802154_transceiver_tx_done_callback_t tx_done_callback_ = nullptr;
   void* tx_done_callback_user_data_ = nullptr;
   ieee802154_transceiver_tx_failed_callback_t tx_failed_callback_ = nullptr;
   void* tx_failed_callback_user_data_ = nullptr;
+  ieee802154_transceiver_tx_complete_callback_t tx_complete_callback_ =
+      nullptr;
+  void* tx_complete_callback_user_data_ = nullptr;
   ieee802154_transceiver_sfd_callback_t sfd_callback_ = nullptr;
   void* sfd_callback_user_data_ = nullptr;
   ieee802154_transceiver_sfd_tx_callback_t sfd_tx_callback_ = nullptr;
@@ -451,8 +959,18 @@ class ESP32TransceiverIEEE802_15_4 {
   bool auto_increment_sequence_number = true;
   bool cca_enabled = false;
 
-  esp_err_t transmit_frame(Frame* frame);
-  void onRxDone(uint8_t* frame, esp_ieee802154_frame_info_t* frame_info);
+  uint32_t transmit_frame(Frame* frame);
+  void updateTxHeader();
+  bool createMessageBuffer();
+  tx_slot_t* beginTxSlot();
+  uint32_t endTxSlot(tx_slot_t* slot, size_t len);
+  tx_slot_t* reserveTxSlot();
+  uint32_t commitTxSlot(tx_slot_t* slot);
+  void processFrame(Frame& frame, frame_data_t* packet);
+  void processBatch();
+  bool acceptsFrame(const FrameView& view);
+  void receiveFromISR(uint8_t* frame, esp_ieee802154_frame_info_t* frame_info,
+                      uint32_t rx_time_us, BaseType_t* task_woken);
   void onTransmitDone(const uint8_t* frame, const uint8_t* ack,
                       esp_ieee802154_frame_info_t* ack_frame_info);
   void onTransmitFailed(const uint8_t* frame, esp_ieee802154_tx_error_t error);
@@ -460,6 +978,45 @@ class ESP32TransceiverIEEE802_15_4 {
   void onStartFrameDelimiterTransmitDone(uint8_t* frame);
 };
 
+/**
+ * @brief ESP32TransceiverIEEE802_15_4 which contains the receive buffer, the TX
+ * queue, the frame pool and the stack of the receive task, so that begin()
+ * does not use the heap. Declare it as global or static object.
+ *
+ * @tparam RxBufferSize Size of the receive message buffer in bytes.
+ * @tparam TxQueueSize Number of TX queue entries.
+ * @tparam RxTaskStackSize Stack size of the receive task in bytes.
+ * @tparam FramePoolSize Number of frame pool slots (0: message buffer is used)
+ * @note setRxBatchCallback() allocates its buffers when it is called.
+ */
+template <size_t RxBufferSize = (sizeof(frame_record_t) + 4) * 8,
+          size_t TxQueueSize = 4, size_t RxTaskStackSize = 1024 * 5,
+          size_t FramePoolSize = 0>
+class ESP32TransceiverIEEE802_15_4Static : public ESP32TransceiverIEEE802_15_4 {
+  static_assert(RxBufferSize >= sizeof(frame_record_t) + 4,
+                "The receive buffer must hold at least one frame");
+
+ public:
+  ESP32TransceiverIEEE802_15_4Static(channel_t channel, int16_t panID,
+                                     Address localAddress)
+      : ESP32TransceiverIEEE802_15_4(channel, panID, localAddress) {
+    setReceiveBufferStorage(rx_buffer_storage, sizeof(rx_buffer_storage));
+    setTxQueueStorage(tx_queue_slots, TxQueueSize);
+    setReceiveTaskStack(rx_task_stack_storage, RxTaskStackSize);
+    if constexpr (FramePoolSize > 0) {
+      setFramePoolStorage(frame_pool_slots.data(), frame_pool_indexes,
+                          FramePoolSize);
+    }
+  }
+
+ protected:
+  uint8_t rx_buffer_storage[RxBufferSize + 1];
+  tx_slot_t tx_queue_slots[TxQueueSize];
+  StackType_t rx_task_stack_storage[RxTaskStackSize];
+  std::array<frame_data_t, FramePoolSize> frame_pool_slots;
+  uint16_t frame_pool_indexes[2 * (FramePoolSize + 1)];
+};
+
 }  // namespace ieee802154
 
 #ifdef ARDUINO
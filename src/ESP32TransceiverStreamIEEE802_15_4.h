@@ -2,6 +2,7 @@
 
 #include "ESP32TransceiverIEEE802_15_4.h"
 #include "RingBuffer.h"
+#include "SelectiveRepeatARQ.h"
 
 namespace ieee802154 {
 
@@ -22,9 +23,22 @@ namespace ieee802154 {
  * When you enable acknowledgment requests for outgoing frames, the stream will
  * wait for the acknowledgment frame from the receiver before sending the next
  * frame. If the acknowledgment is not received within the configured timeout,
- * the stream will retry sending the frame after a delay. This process will
- * repeat until the frame is acknowledged or a maximum number of retries is
- * reached.
+ * the stream will retry sending the frame. This process will repeat until the
+ * frame is acknowledged or a maximum number of retries is reached.
+ *
+ * The sending is driven by the transmission results of the radio: the next
+ * frame is sent as soon as the radio is free. A minimum spacing between frames
+ * can be defined with setSendDelay() if the receiver needs it.
+ *
+ * Optionally a selective repeat ARQ transport can be activated on both sides
+ * with setArqActive(): a window of frames can be outstanding, lost frames are
+ * detected by acknowledgments sent in the reverse direction and only they are
+ * sent again. The receiver reorders the frames before they are made available.
+ *
+ * By default the frames are received in the task that reads from the stream.
+ * With setRxTaskActive() a separate task receives the frames in the background
+ * and fills the receive buffer, while the application reads from it
+ * concurrently.
  */
 class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
  public:
@@ -57,6 +71,16 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
    * @brief Destroy the ESP32TransceiverStream object.
    */
   ~ESP32TransceiverStreamIEEE802_15_4() {
+    stopRxTask();
+    if (tx_semaphore) {
+      vSemaphoreDelete(tx_semaphore);
+    }
+    if (rx_semaphore) {
+      vSemaphoreDelete(rx_semaphore);
+    }
+    if (arq_mutex) {
+      vSemaphoreDelete(arq_mutex);
+    }
     if (owns_transceiver) {
       delete p_transceiver;
     }
@@ -83,8 +107,8 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
   int getRxMessageBufferSize() const { return receive_msg_buffer_size; }
 
   /**
-   * @brief Get the delay between send retries in milliseconds.
-   * @return The retry delay in ms.
+   * @brief Get the minimum spacing between frames in milliseconds.
+   * @return The minimum spacing in ms.
    */
   int getSendDelay() const { return send_delay_ms; }
 
@@ -166,8 +190,10 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
   }
 
   /**
-   * @brief Set the delay between sends or send retries.
-   * @param delay_ms Delay in milliseconds.
+   * @brief Set the minimum spacing between sends or send retries. By default
+   * the next frame is sent as soon as the radio is free: only use this if the
+   * receiver can not keep up.
+   * @param delay_ms Minimum spacing in milliseconds (default 0).
    */
   void setSendDelay(int delay_ms) { send_delay_ms = delay_ms; }
 
@@ -177,6 +203,76 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
    */
   void setSendRetryCount(int count) { send_retry_count = count; }
 
+  /**
+   * @brief Activate the selective repeat ARQ transport. This must be done on
+   * the sending and on the receiving side.
+   * @param active True to activate the ARQ transport.
+   * @param window_size Maximum number of unacknowledged frames (power of 2, max
+   * 32).
+   * @param retransmit_timeout_ms Time after which unacknowledged frames are
+   * sent again.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setArqActive(bool active, int window_size = 8,
+                    uint32_t retransmit_timeout_ms = 30) {
+    is_arq_active = active;
+    arq_window_size = window_size;
+    arq_retransmit_timeout_ms = retransmit_timeout_ms;
+  }
+
+  /**
+   * @brief Check if the selective repeat ARQ transport is active.
+   * @return True if the ARQ transport is active.
+   */
+  bool isArqActive() const { return is_arq_active; }
+
+  /**
+   * @brief Receive the frames in a separate task that fills the receive buffer
+   * in the background.
+   * @param active True to use a receive task.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setRxTaskActive(bool active) { is_rx_task_active = active; }
+
+  /**
+   * @brief Check if the frames are received in a separate task.
+   * @return True if a receive task is used.
+   */
+  bool isRxTaskActive() const { return is_rx_task_active; }
+
+  /**
+   * @brief Defines the core, priority and stack of the receive task.
+   * @param config The receive task configuration.
+   * @note This method must be called before begin() to take effect!
+   */
+  void setRxTaskConfig(const rx_task_config_t& config) {
+    rx_task_config = config;
+  }
+
+  /**
+   * @brief Get the minimum free stack of the receive task since it was
+   * started.
+   * @return The free stack in bytes or 0 if the task is not running.
+   */
+  uint32_t getRxTaskStackHighWaterMark() const {
+    if (rx_task_handle == nullptr) return 0;
+    return uxTaskGetStackHighWaterMark(rx_task_handle);
+  }
+
+  /**
+   * @brief Processes received frames, retransmissions and acknowledgments of
+   * the ARQ transport. This is done automatically by read() and write(): call
+   * it regularly if you do neither.
+   */
+  void update() {
+    if (is_arq_active) {
+      if (rx_task_handle == nullptr) receive(0);
+      lockArq();
+      arq.update(millis());
+      unlockArq();
+    }
+  }
+
   /**
    * @brief Enable or disable CCA (Clear Channel Assessment).
    * @param cca_enabled True to enable CCA (Clear Channel Assessment), false to
@@ -207,15 +303,38 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
     p_transceiver->setReceiveTask(nullptr);
     p_transceiver->setReceiveBufferSize(
         receive_msg_buffer_size);  // Set default message buffer size
-    setRxBufferSize(1024);
+    rx_buffer.clear();
     p_transceiver->setTxDoneCallback(ieee802154_transceiver_tx_done_callback,
                                      this);
     p_transceiver->setTxFailedCallback(
         ieee802154_transceiver_tx_failed_callback, this);
+    if (is_arq_active) {
+      if (!arq.begin(arq_window_size, getMaxMTU(),
+                     arq_retransmit_timeout_ms)) {
+        ESP_LOGE(TAG, "Invalid ARQ window size or storage: %d",
+                 arq_window_size);
+        return false;
+      }
+      arq.setOutput(arq_output_callback, this);
+      arq.setDeliver(arq_deliver_callback, this);
+      arq_retransmit_count = arq_duplicate_count = 0;
+      if (tx_buffer.size() > getMaxMTU()) tx_buffer.resize(getMaxMTU());
+    }
     // start with 1;
     p_transceiver->incrementSequenceNumber(1);
+    // signaled by the tx callbacks
+    if (tx_semaphore == nullptr) {
+      tx_semaphore = xSemaphoreCreateBinaryStatic(&tx_semaphore_buffer);
+      if (tx_semaphore == nullptr) {
+        ESP_LOGE(TAG, "Failed to create tx semaphore");
+        return false;
+      }
+    }
 
-    return p_transceiver->begin();
+    if (!p_transceiver->begin()) {
+      return false;
+    }
+    return !is_rx_task_active || startRxTask();
   }
 
   /**
@@ -230,7 +349,10 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
   /**
    * @brief Deinitialize the stream and underlying transceiver.
    */
-  void end() { p_transceiver->end(); }
+  void end() {
+    stopRxTask();
+    p_transceiver->end();
+  }
 
   /**
    * @brief Write a buffer of bytes to the transceiver.
@@ -240,14 +362,11 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
    */
   size_t write(const uint8_t* buffer, size_t size) override {
     size_t written = 0;
-    for (size_t i = 0; i < size; i++) {
-      if (write(buffer[i]) == 1) {
-        written++;
-      } else {
-        break;  // Stop if we can't write more
-      }
+    while (written < size) {
+      written += tx_buffer.writeArray(buffer + written, size - written);
+      if (tx_buffer.isFull()) sendTxBuffer();
     }
-    if (size < MTU) flush();
+    if (size < MTU) sendTxBuffer();
     return written;
   }
 
@@ -259,7 +378,7 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
   size_t write(const uint8_t byte) override {
     bool rc = tx_buffer.write(byte);
     if (tx_buffer.isFull()) {
-      flush();
+      sendTxBuffer();
     }
     return rc ? 1 : 0;
   }
@@ -268,7 +387,8 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
    * @return The byte read, or -1 if no data is available.
    */
   int read() override {
-    receive();
+    if (rx_task_handle == nullptr) receive();
+    if (rx_buffer.isEmpty()) return -1;
     return rx_buffer.read();
   }
 
@@ -279,9 +399,18 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
    * @return Number of bytes actually read.
    */
   size_t readBytes(uint8_t* buffer, size_t size) {
-    // fill receive buffer
-    uint32_t end = millis() + _timeout;
-    while (receive() && millis() < end);
+    uint32_t start = millis();
+    if (rx_task_handle != nullptr) {
+      // wait for the receive task to provide the data
+      while (rx_buffer.available() < (int)size) {
+        uint32_t elapsed = millis() - start;
+        if (elapsed >= _timeout) break;
+        xSemaphoreTake(rx_semaphore, pdMS_TO_TICKS(_timeout - elapsed));
+      }
+    } else {
+      // fill receive buffer
+      while (receive() && millis() - start < _timeout);
+    }
     // provide data from receive buffer
     return rx_buffer.readArray(buffer, size);
   }
@@ -291,7 +420,7 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
    * @return The next byte, or -1 if no data is available.
    */
   int peek() {
-    if (rx_buffer.isEmpty()) receive();
+    if (rx_buffer.isEmpty() && rx_task_handle == nullptr) receive();
     uint8_t c = 0;
     bool rc = rx_buffer.peek(c);
     return rc ? c : -1;
@@ -312,14 +441,17 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
   /**
    * @brief Flush the transmit buffer and send its contents as a frame.
    *
-   * Sends all buffered data via the transceiver and clears the buffer.
+   * Sends all buffered data via the transceiver and clears the buffer. When
+   * the ARQ transport is active, we also wait until all frames have been
+   * acknowledged (limited by the stream timeout).
    */
   void flush() override {
-    // get data from buffer
-    if (isSendConfirmations()) {
-      sendWithConfirmations();
-    } else {
-      sendWithoutConfirmations();
+    sendTxBuffer();
+    if (is_arq_active) {
+      uint32_t start = millis();
+      while (!isArqIdle() && millis() - start < _timeout) {
+        pollReceive(pdMS_TO_TICKS(1));
+      }
     }
   }
 
@@ -383,9 +515,12 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
   /**
    * @brief Get the maximum transmission unit (MTU) size for the data content
    * @return The MTU size in bytes: 116 bytes for data payload (127 bytes total
-   * frame size minus 11 bytes for frame overhead).
+   * frame size minus 11 bytes for frame overhead). With the ARQ transport the
+   * ARQ header is subtracted as well.
    */
-  int getMaxMTU() const { return MTU; }
+  int getMaxMTU() const {
+    return is_arq_active ? MTU - SelectiveRepeatARQ::HEADER_SIZE : MTU;
+  }
 
   /**
    * @brief Set the transmit buffer size for the stream. This defines how much
@@ -415,13 +550,18 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
  protected:
   static constexpr const char* TAG = "ESP32TransceiverStream";
   static constexpr int MTU = 116;
+  static constexpr uint32_t TX_QUEUE_TIMEOUT_MS = 100;
+  static constexpr uint32_t ARQ_UPDATE_MS = 5;
+  static constexpr int RX_TASK_STACK_SIZE = 1024 * 4;
+  static constexpr int RX_TASK_PRIORITY = 5;
   int receive_msg_buffer_size =
       (sizeof(frame_data_t) + 4) * 100;  // Default size for message buffer
   ESP32TransceiverIEEE802_15_4* p_transceiver = nullptr;
   bool owns_transceiver = false;
-  RingBuffer rx_buffer{1024 + MTU};
+  SPSCRingBuffer rx_buffer{1024 + MTU};
   RingBuffer tx_buffer{MTU};
-  Frame frame;  // For parsing and buffering received frames
+  FrameView frame;  // For parsing and buffering received frames
+  frame_data_t packet;  // Storage for the received frame data
   bool is_open_frame = false;
   enum send_confirmation_state_t {
     WAITING_FOR_CONFIRMATION,
@@ -432,11 +572,29 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
       WAITING_FOR_CONFIRMATION;
   bool is_send_confirations_enabled = false;
   bool is_auto_flush = false;
-  /// Delay after sending a frame when confirmations are not used
-  int send_delay_ms = 10;
+  /// Minimum spacing between frames
+  int send_delay_ms = 0;
+  uint32_t last_send_ms = 0;
+  SemaphoreHandle_t tx_semaphore = nullptr;
+  StaticSemaphore_t tx_semaphore_buffer;
   int last_seq = -1;
   int send_retry_count = 2;
+  SelectiveRepeatARQ arq;
+  bool is_arq_active = false;
+  int arq_window_size = 8;
+  uint32_t arq_retransmit_timeout_ms = 30;
+  uint32_t arq_retransmit_count = 0;  // reported to the statistics
+  uint32_t arq_duplicate_count = 0;   // reported to the statistics
   esp_ieee802154_tx_error_t last_tx_error = ESP_IEEE802154_TX_ERR_NONE;
+  bool is_rx_task_active = false;
+  TaskHandle_t rx_task_handle = nullptr;
+  SemaphoreHandle_t rx_semaphore = nullptr;  // signaled by the receive task
+  SemaphoreHandle_t arq_mutex = nullptr;     // used with a receive task only
+  StaticSemaphore_t rx_semaphore_buffer;
+  StaticSemaphore_t arq_mutex_buffer;
+  rx_task_config_t rx_task_config{"StreamRX", RX_TASK_STACK_SIZE,
+                                  RX_TASK_PRIORITY};
+  StaticTask_t rx_task_buffer;
 
   bool isSendConfirmations() { return getFrameControlField().ackRequest == 1; }
 
@@ -444,52 +602,173 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
     return getFrameControlField().sequenceNumberSuppression == 0;
   }
 
+  /// Waits until the minimum spacing to the last frame has passed
+  void waitForSendSpacing() {
+    if (send_delay_ms <= 0) return;
+    uint32_t elapsed = millis() - last_send_ms;
+    if (elapsed < (uint32_t)send_delay_ms) {
+      delay(send_delay_ms - elapsed);
+    }
+  }
+
+  /// Sends the data and records the send time
+  bool sendFrame(uint8_t* data, size_t len) {
+    waitForSendSpacing();
+    bool rc = p_transceiver->send(data, len);
+    last_send_ms = millis();
+    return rc;
+  }
+
+  /// Creates the task that fills the receive buffer
+  bool startRxTask() {
+    if (rx_semaphore == nullptr) {
+      rx_semaphore = xSemaphoreCreateBinaryStatic(&rx_semaphore_buffer);
+    }
+    if (is_arq_active && arq_mutex == nullptr) {
+      arq_mutex = xSemaphoreCreateMutexStatic(&arq_mutex_buffer);
+    }
+    if (rx_semaphore == nullptr || (is_arq_active && arq_mutex == nullptr)) {
+      ESP_LOGE(TAG, "Failed to create rx task semaphores");
+      return false;
+    }
+    rx_task_handle = rx_task_config.create(rx_task, this, &rx_task_buffer);
+    if (rx_task_handle == nullptr) {
+      ESP_LOGE(TAG, "Failed to create receive task");
+      return false;
+    }
+    return true;
+  }
+
+  /// Deletes the receive task: it must not hold the ARQ lock at this time
+  void stopRxTask() {
+    if (rx_task_handle == nullptr) return;
+    lockArq();
+    vTaskDelete(rx_task_handle);
+    rx_task_handle = nullptr;
+    unlockArq();
+  }
+
+  /// Receive task: fills the receive buffer and drives the ARQ timers
+  static void rx_task(void* ref) {
+    ESP32TransceiverStreamIEEE802_15_4& self =
+        *static_cast<ESP32TransceiverStreamIEEE802_15_4*>(ref);
+    TickType_t wait =
+        self.is_arq_active ? pdMS_TO_TICKS(ARQ_UPDATE_MS) : portMAX_DELAY;
+    while (true) {
+      if (self.receive(wait)) {
+        xSemaphoreGive(self.rx_semaphore);
+      }
+    }
+  }
+
+  /// Waits for new frames: without receive task they are received here
+  void pollReceive(TickType_t wait) {
+    if (rx_task_handle != nullptr) {
+      vTaskDelay(wait > 0 ? wait : 1);
+    } else {
+      receive(wait);
+    }
+  }
+
+  void lockArq() {
+    if (arq_mutex) xSemaphoreTake(arq_mutex, portMAX_DELAY);
+  }
+
+  void unlockArq() {
+    updateArqStatistics();
+    if (arq_mutex) xSemaphoreGive(arq_mutex);
+  }
+
+  /// Adds the new ARQ retransmissions and duplicates to the statistics
+  void updateArqStatistics() {
+    TransceiverStatistics& stats = p_transceiver->statistics();
+    if (arq.retransmitCount() != arq_retransmit_count) {
+      stats.addRetransmissions(arq.retransmitCount() - arq_retransmit_count);
+      arq_retransmit_count = arq.retransmitCount();
+    }
+    if (arq.duplicateCount() != arq_duplicate_count) {
+      stats.addDuplicates(arq.duplicateCount() - arq_duplicate_count);
+      arq_duplicate_count = arq.duplicateCount();
+    }
+  }
+
+  bool isArqIdle() {
+    lockArq();
+    bool rc = arq.isIdle();
+    unlockArq();
+    return rc;
+  }
+
+  /// Sends the content of the tx buffer as frame
+  void sendTxBuffer() {
+    if (tx_buffer.isEmpty()) {
+      return;
+    } else if (is_arq_active) {
+      sendWithArq();
+    } else if (isSendConfirmations()) {
+      sendWithConfirmations();
+    } else {
+      sendWithoutConfirmations();
+    }
+  }
+
   /**
-   * @brief Internal method to receive frames and fill the receive buffer.
+   * @brief Internal method to receive frames and fill the receive buffer. It
+   * is called either by the receive task or by the reading task, which is the
+   * only writer of the receive buffer.
+   * @param wait Maximum time to wait for a frame in ticks.
    * @return True if a frame was received and processed, false otherwise.
    */
-  bool receive() {
-    frame_data_t packet;  // Temporary storage for received frame data
+  bool receive(TickType_t wait = pdMS_TO_TICKS(20)) {
     if (is_open_frame) {
       // We have a pending frame that we haven't processed yet
-      if (frame.payloadLen > rx_buffer.availableForWrite()) {
+      if (frame.payloadLen() > rx_buffer.availableForWrite()) {
         delay(10);
         return false;
       }
       // Store payload in receive buffer
-      rx_buffer.writeArray(frame.payload, frame.payloadLen);
+      rx_buffer.writeArray(frame.payload(), frame.payloadLen());
       is_open_frame = false;  // Mark frame as processed
       return true;
     }
 
     // get next frame
-    size_t read_bytes = 0;
-    read_bytes =
-        xMessageBufferReceive(p_transceiver->getMessageBuffer(), &packet,
-                              sizeof(frame_data_t), pdMS_TO_TICKS(20));
-    if (read_bytes != sizeof(frame_data_t)) {
-      if (read_bytes != 0) {
-        ESP_LOGE(TAG, "Invalid packet size received: %d", read_bytes);
+    if (!p_transceiver->readFrame(packet, wait)) {
+      if (is_arq_active) {
+        lockArq();
+        arq.update(millis());
+        unlockArq();
       }
       return false;
     }
 
     // Parse frame
-    if (!frame.parse(packet.frame, false)) {
+    if (!frame.parse(packet.frame)) {
       ESP_LOGE(TAG, "Failed to parse frame");
+      p_transceiver->statistics().addRxParseError();
       return false;
     }
 
-    ESP_LOGI(TAG, "Received frame: len=%d, seq=%d", frame.payloadLen,
-             frame.sequenceNumber);
+    // ARQ frames are reordered and delivered by the ARQ transport
+    if (is_arq_active) {
+      lockArq();
+      bool rc = arq.receive(frame.payload(), frame.payloadLen(), millis());
+      arq.update(millis());
+      unlockArq();
+      return rc;
+    }
+
+    ESP_LOGI(TAG, "Received frame: len=%d, seq=%d", frame.payloadLen(),
+             frame.sequenceNumber());
 
     // Sequence number check (after successful parse, before buffer handling)
     if (isSequenceNumbers()) {
-      int seq = frame.sequenceNumber;
+      int seq = frame.sequenceNumber();
       if (last_seq != -1) {
         int expected = (last_seq + 1) % 256;
         if (seq == last_seq) {
           ESP_LOGI(TAG, "Retransmission ignored: seq %d", seq);
+          p_transceiver->statistics().addDuplicates();
           return false;  // Ignore duplicate
         } else if (seq != expected) {
           ESP_LOGI(TAG, "Frame sequence skipped: expected %d, got %d", expected,
@@ -500,17 +779,16 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
       last_seq = seq;
     }
 
-    if (frame.payloadLen > rx_buffer.availableForWrite()) {
+    if (frame.payloadLen() > rx_buffer.availableForWrite()) {
       // will be made availabe with next call
       ESP_LOGD(TAG, "Received frame payload too large for buffer: %d bytes",
-               frame.payloadLen);
+               frame.payloadLen());
       is_open_frame = true;
       return false;
     }
 
     // Store payload in receive buffer
-    rx_buffer.writeArray(frame.payload, frame.payloadLen);
-    delay(5);
+    rx_buffer.writeArray(frame.payload(), frame.payloadLen());
 
     return true;
   }
@@ -528,19 +806,21 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
     int attempt = 0;
     do {
       // send data
+      xSemaphoreTake(tx_semaphore, 0);  // clear outdated signal
       send_confirmation_state = WAITING_FOR_CONFIRMATION;
       ESP_LOGD(TAG, "Attempt %d: Sending frame, len: %d", attempt, len);
-      if (!p_transceiver->send(tmp, len)) {
+      if (!sendFrame(tmp, len)) {
         ESP_LOGE(TAG, "Failed to send frame: size %d", len);
         send_confirmation_state = CONFIRMATION_ERROR;
       }
 
-      // wait for confirmations
-      uint32_t timeout =
-          millis() + (getAckTimeoutUs() / 1000) + 2;  // Add some margin
-      while (send_confirmation_state == WAITING_FOR_CONFIRMATION &&
-             millis() < timeout) {
-        delay(2);
+      // wait for confirmations signaled by the tx callbacks
+      uint32_t start = millis();
+      uint32_t timeout = (getAckTimeoutUs() / 1000) + 2;  // Add some margin
+      while (send_confirmation_state == WAITING_FOR_CONFIRMATION) {
+        uint32_t elapsed = millis() - start;
+        if (elapsed >= timeout) break;
+        xSemaphoreTake(tx_semaphore, pdMS_TO_TICKS(timeout - elapsed));
       }
 
       // on error retry sending the same frame
@@ -551,42 +831,93 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
           if (retry <= 0) {
             // abort retry and move to next frame
             p_transceiver->incrementSequenceNumber(1);
-            delay(send_delay_ms);
             return;
           }
-          // Short delay before retrying
-          delay(send_delay_ms);
           break;
         }
         case CONFIRMATION_RECEIVED: {
           p_transceiver->incrementSequenceNumber(1);
-          delay(send_delay_ms);
           break;
         }
         default:
           // we should not be here, but if we are, we just retry
           retry--;
-          delay(send_delay_ms);  // Short delay before retrying if needed
           break;
       }
       ++attempt;
+      if (send_confirmation_state == CONFIRMATION_ERROR) {
+        p_transceiver->statistics().addRetransmissions();
+      }
     } while (send_confirmation_state == CONFIRMATION_ERROR);
   }
 
   /**
    * @brief Internal method to send a frame without waiting for confirmations.
-   * Adds a delay after sending to allow the transceiver to process the frame.
+   * The frame is queued in the transceiver: if the TX queue is full we wait
+   * until the radio has finished the next transmission.
    */
   void sendWithoutConfirmations() {
     uint8_t tmp[tx_buffer.available()];
     int len = tx_buffer.readArray(tmp, tx_buffer.available());
     ESP_LOGD(TAG, "Sending frame, len: %d", len);
-    if (p_transceiver->send(tmp, len)) {
+    uint32_t start = millis();
+    while (p_transceiver->getTxQueueAvailable() == 0 &&
+           millis() - start < TX_QUEUE_TIMEOUT_MS) {
+      xSemaphoreTake(tx_semaphore, pdMS_TO_TICKS(TX_QUEUE_TIMEOUT_MS));
+    }
+    if (sendFrame(tmp, len)) {
       p_transceiver->incrementSequenceNumber(1);
     } else {
       ESP_LOGE(TAG, "Failed to send frame: size %d", len);
     }
-    delay(send_delay_ms);
+  }
+
+  /**
+   * @brief Internal method to send a frame with the ARQ transport. Waits until
+   * the window has space for a new frame.
+   */
+  void sendWithArq() {
+    uint8_t tmp[tx_buffer.available()];
+    int len = tx_buffer.readArray(tmp, tx_buffer.available());
+    uint32_t start = millis();
+    lockArq();
+    while (!arq.canWrite()) {
+      if (millis() - start >= _timeout) {
+        unlockArq();
+        ESP_LOGE(TAG, "ARQ window full: dropping %d bytes", len);
+        return;
+      }
+      unlockArq();
+      pollReceive(pdMS_TO_TICKS(1));
+      lockArq();
+      arq.update(millis());
+    }
+    arq.write(tmp, len, millis());
+    unlockArq();
+  }
+
+  /// ARQ output: sends a data or ack frame
+  static bool arq_output_callback(const uint8_t* data, size_t len, void* ref) {
+    ESP32TransceiverStreamIEEE802_15_4& self =
+        *static_cast<ESP32TransceiverStreamIEEE802_15_4*>(ref);
+    uint32_t start = millis();
+    while (self.p_transceiver->getTxQueueAvailable() == 0 &&
+           millis() - start < TX_QUEUE_TIMEOUT_MS) {
+      xSemaphoreTake(self.tx_semaphore, pdMS_TO_TICKS(TX_QUEUE_TIMEOUT_MS));
+    }
+    if (!self.sendFrame((uint8_t*)data, len)) return false;
+    self.p_transceiver->incrementSequenceNumber(1);
+    return true;
+  }
+
+  /// ARQ deliver: stores the received data in order in the receive buffer
+  static bool arq_deliver_callback(const uint8_t* data, size_t len,
+                                   void* ref) {
+    ESP32TransceiverStreamIEEE802_15_4& self =
+        *static_cast<ESP32TransceiverStreamIEEE802_15_4*>(ref);
+    if (len > self.rx_buffer.availableForWrite()) return false;
+    self.rx_buffer.writeArray(data, len);
+    return true;
   }
 
   /**
@@ -599,6 +930,7 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
         *static_cast<ESP32TransceiverStreamIEEE802_15_4*>(user_data);
     self.send_confirmation_state = CONFIRMATION_RECEIVED;
     self.last_tx_error = ESP_IEEE802154_TX_ERR_NONE;
+    self.signalTxResult();
   }
 
   /**
@@ -610,7 +942,60 @@ class ESP32TransceiverStreamIEEE802_15_4 : public Stream {
         *static_cast<ESP32TransceiverStreamIEEE802_15_4*>(user_data);
     self.send_confirmation_state = CONFIRMATION_ERROR;
     self.last_tx_error = error;
+    self.signalTxResult();
+  }
+
+  /// Wakes up the sending task: called from the tx callbacks (ISR)
+  void signalTxResult() {
+    if (tx_semaphore == nullptr) return;
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(tx_semaphore, &higher_priority_task_woken);
+    if (higher_priority_task_woken) {
+      portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+  }
+};
+
+/**
+ * @brief ESP32TransceiverStreamIEEE802_15_4 that does not use the heap: the
+ * RX and TX buffers, the ARQ frame buffers and the stack of the receive task
+ * are part of the object.
+ *
+ * Use it together with ESP32TransceiverIEEE802_15_4Static. The ARQ can only
+ * be activated with a window size up to ArqWindowSize.
+ * @tparam RxBufferSize Size of the receive ring buffer in bytes.
+ * @tparam ArqWindowSize Maximum ARQ window size: 0 if the ARQ is not used.
+ * @tparam RxTaskStackSize Stack size of the receive task in bytes.
+ */
+template <size_t RxBufferSize = 1024 + 116, size_t ArqWindowSize = 0,
+          size_t RxTaskStackSize = 1024 * 4>
+class ESP32TransceiverStreamIEEE802_15_4Static
+    : public ESP32TransceiverStreamIEEE802_15_4 {
+ public:
+  ESP32TransceiverStreamIEEE802_15_4Static(
+      ESP32TransceiverIEEE802_15_4& transceiver)
+      : ESP32TransceiverStreamIEEE802_15_4(transceiver) {
+    rx_buffer.setStorage(rx_data, RxBufferSize);
+    tx_buffer.setStorage(tx_data, MTU);
+    if constexpr (ArqWindowSize > 0) {
+      arq.setStorage(arq_data, sizeof(arq_data));
+    }
+    rx_task_config.stack = rx_task_stack_storage;
+    rx_task_config.stack_size = RxTaskStackSize;
+    // keep the message buffer that fits into the provided storage
+    receive_msg_buffer_size = transceiver.getReceiveBufferSize();
   }
+
+ protected:
+  static_assert(ArqWindowSize <= SelectiveRepeatARQ::MAX_WINDOW_SIZE,
+                "ARQ window size too big");
+  uint8_t rx_data[RxBufferSize];
+  uint8_t tx_data[MTU];
+  uint8_t arq_data[ArqWindowSize > 0 ? SelectiveRepeatARQ::storageSize(
+                                           ArqWindowSize,
+                                           MTU - SelectiveRepeatARQ::HEADER_SIZE)
+                                     : 1];
+  StackType_t rx_task_stack_storage[RxTaskStackSize];
 };
 
 /// @brief Alias for ESP32TransceiverStreamIEEE802_15_4 to simplify usage.
@@ -38,6 +38,25 @@ enum class addr_mode_t : uint8_t {
   EXTENDED = 0x3,  // 64-bit extended address
 };
 
+/// Length in bytes of an address with the mode: 0 for NONE and RESERVED
+constexpr uint8_t addressLength(addr_mode_t mode) {
+  switch (mode) {
+    case addr_mode_t::SHORT:
+      return 2;
+    case addr_mode_t::EXTENDED:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/// Address bytes (in frame order) as little endian value, e.g. as table key
+inline uint64_t addressKey(const uint8_t* address, uint8_t len) {
+  uint64_t key = 0;
+  for (int j = len - 1; j >= 0; j--) key = (key << 8) | address[j];
+  return key;
+}
+
 /// IEEE 802.15.4 frame version enumerations
 enum class frame_version_t : uint8_t {
   V_2003 = 0x0,       // IEEE 802.15.4-2003
@@ -123,6 +142,18 @@ class Address {
    */
   addr_mode_t mode() { return local_addr_mode; }
 
+  /**
+   * @brief Get the length of the address.
+   * @return 2 for SHORT, 8 for EXTENDED and 0 for no address.
+   */
+  uint8_t length() const { return addressLength(local_addr_mode); }
+
+  /**
+   * @brief Get the address bytes as little endian value.
+   * @return Key for lookup tables, see addressKey().
+   */
+  uint64_t key() const { return addressKey(local_address, length()); }
+
   /**
    * @brief Get a human-readable string representation of the address.
    * @return Pointer to static string buffer.
@@ -243,8 +274,81 @@ struct Frame {
 struct frame_data_t {
   uint8_t frame[MAX_FRAME_LEN];            // Raw frame data
   esp_ieee802154_frame_info_t frame_info;  // Frame info (RSSI, LQI, etc.)
+  uint32_t rx_time_us = 0;  // esp_timer time when the frame was received
 };
 
+/// Air time of a byte in microseconds (O-QPSK PHY with 250 kbit/s)
+constexpr uint32_t BYTE_TIME_US = 32;
+
+/// Length of the synchronization header (preamble and SFD) in bytes
+constexpr uint32_t SHR_LEN = 5;
+
+/**
+ * @brief Time at which the transmission of a received frame started.
+ *
+ * esp_ieee802154_frame_info_t::timestamp is the esp_timer time in
+ * microseconds at which the SFD of the frame was received. This is the time
+ * base of all timestamps in this library, e.g. of the pcapng capture and of
+ * the TSCH synchronization: the preamble and the SFD were sent before it.
+ */
+inline uint64_t rxFrameStartUs(const esp_ieee802154_frame_info_t& info) {
+  return info.timestamp - SHR_LEN * BYTE_TIME_US;
+}
+
+/**
+ * @brief Compact variable size record for a received frame.
+ *
+ * This is the format that is stored in the RX message buffer: only the
+ * frame_info fields that we use and the frame[0] + 1 bytes of the frame are
+ * stored, so that small frames (e.g. ACKs) only need a fraction of the space of
+ * a frame_data_t.
+ */
+struct __attribute__((packed)) frame_record_t {
+  uint64_t timestamp = 0;        // Frame info timestamp
+  int8_t rssi = 0;               // Frame info RSSI
+  uint8_t lqi = 0;               // Frame info LQI
+  uint8_t channel = 0;           // Frame info channel
+  uint8_t flags = 0;             // Bit 0: pending, bit 1: process
+  uint32_t rx_time_us = 0;       // esp_timer time when the frame was received
+  uint8_t frame[MAX_FRAME_LEN];  // Length byte followed by the frame
+
+  /// Fill the record from the raw frame and the frame info
+  void set(const uint8_t* data, const esp_ieee802154_frame_info_t& info,
+           uint32_t rxTimeUs = 0) {
+    size_t len = data[0] < MAX_FRAME_LEN ? data[0] : MAX_FRAME_LEN - 1;
+    memcpy(frame, data, len + 1);
+    frame[0] = len;
+    timestamp = info.timestamp;
+    rssi = info.rssi;
+    lqi = info.lqi;
+    channel = info.channel;
+    flags = (info.pending ? 0x01 : 0) | (info.process ? 0x02 : 0);
+    rx_time_us = rxTimeUs;
+  }
+
+  /// Copy the content of the record into a frame_data_t
+  void get(frame_data_t& out) const {
+    memcpy(out.frame, frame, frame[0] + 1);
+    out.frame_info.pending = flags & 0x01;
+    out.frame_info.process = flags & 0x02;
+    out.frame_info.channel = channel;
+    out.frame_info.rssi = rssi;
+    out.frame_info.lqi = lqi;
+    out.frame_info.timestamp = timestamp;
+    out.rx_time_us = rx_time_us;
+  }
+
+  /// Number of bytes of the record that are in use
+  size_t size() const { return HEADER_SIZE + frame[0] + 1; }
+
+  /// Size of the record without the frame data
+  static constexpr size_t HEADER_SIZE = 16;
+};
+
+ESP_STATIC_ASSERT(sizeof(frame_record_t) ==
+                      frame_record_t::HEADER_SIZE + MAX_FRAME_LEN,
+                  "frame_record_t must be packed");
+
 
 // Ensure FCF structure is exactly 2 bytes
 ESP_STATIC_ASSERT(sizeof(FrameControlField) == IEEE802154_FCF_SIZE,
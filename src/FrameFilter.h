@@ -0,0 +1,242 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <initializer_list>
+#include <vector>
+
+#include "Frame.h"
+#include "FrameView.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Compact open addressing hash set for integer keys.
+ *
+ * The keys are stored in a single array with a power of 2 size and are found
+ * with linear probing, so that a lookup is a multiplication, a shift and
+ * usually a single compare. The maximum value of T marks an empty slot and can
+ * not be added. The load factor is kept at or below 1/2.
+ *
+ * add() may allocate: contains() never does and can be called from an ISR.
+ */
+template <typename T>
+class HashSet {
+ public:
+  /// Value that marks an empty slot
+  static constexpr T EMPTY = static_cast<T>(~static_cast<T>(0));
+
+  /// Allocates the space for count keys
+  void reserve(size_t count) {
+    size_t capacity = 8;
+    while (capacity < count * 2) capacity *= 2;
+    if (capacity > slots.size()) rehash(capacity);
+  }
+
+  /// Adds the key: returns false for the EMPTY value
+  bool add(T key) {
+    if (key == EMPTY) return false;
+    if ((len + 1) * 2 > slots.size()) {
+      rehash(slots.empty() ? 8 : slots.size() * 2);
+    }
+    size_t idx = index(key);
+    while (slots[idx] != EMPTY) {
+      if (slots[idx] == key) return true;
+      idx = (idx + 1) & mask;
+    }
+    slots[idx] = key;
+    len++;
+    return true;
+  }
+
+  /// Returns true if the key has been added
+  bool contains(T key) const {
+    if (len == 0) return false;
+    size_t idx = index(key);
+    while (slots[idx] != EMPTY) {
+      if (slots[idx] == key) return true;
+      idx = (idx + 1) & mask;
+    }
+    return false;
+  }
+
+  /// Removes all keys: the memory is kept
+  void clear() {
+    for (auto& slot : slots) slot = EMPTY;
+    len = 0;
+  }
+
+  /// Number of keys
+  size_t size() const { return len; }
+
+  /// Returns true if no key has been added
+  bool isEmpty() const { return len == 0; }
+
+ protected:
+  std::vector<T> slots;
+  size_t len = 0;
+  size_t mask = 0;
+  uint8_t shift = 64;  // 64 - log2(capacity)
+
+  size_t index(T key) const {
+    // Fibonacci hashing: the top log2(capacity) bits of the product are the
+    // best mixed ones
+    uint64_t hash = (uint64_t)key * 0x9E3779B97F4A7C15ull;
+    return (size_t)(hash >> shift);
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<T> old;
+    old.swap(slots);
+    slots.assign(capacity, EMPTY);
+    mask = capacity - 1;
+    shift = 64;
+    for (size_t size = capacity; size > 1; size >>= 1) shift--;
+    len = 0;
+    for (T key : old) {
+      if (key != EMPTY) add(key);
+    }
+  }
+};
+
+/**
+ * @brief Filter table that is evaluated on the raw frame in the receive ISR,
+ * so that uninteresting frames are dropped before they are copied into the
+ * receive queue, parsed and passed to the callback.
+ *
+ * A frame is accepted if all of the following conditions are met:
+ * - its frame type is enabled (by default all types are),
+ * - the destination or source PAN ID is in the PAN table (if it is not empty),
+ * - the destination or source address is in the address table (if it is not
+ * empty).
+ *
+ * Frames without PAN ID or address do not match a table that is not empty.
+ * Invalid frames are always dropped.
+ *
+ * Set up the filter before calling begin(): it must not be changed while the
+ * transceiver is active. Use reserve() if you want to avoid rehashing while
+ * many entries are added.
+ *
+ * Example:
+ * @code
+ * FrameFilter filter;
+ * filter.addPanId(0x1234);
+ * filter.setFrameTypes({Frameype_t::DATA});
+ * transceiver.setFrameFilter(&filter);
+ * @endcode
+ */
+class FrameFilter {
+ public:
+  /// Reserves the space for the indicated number of entries
+  void reserve(size_t panIds, size_t shortAddresses,
+               size_t extendedAddresses = 0) {
+    pans.reserve(panIds);
+    short_addresses.reserve(shortAddresses);
+    extended_addresses.reserve(extendedAddresses);
+  }
+
+  /// Enables or disables a frame type
+  void setFrameTypeActive(Frameype_t type, bool active) {
+    uint8_t bit = 1 << static_cast<uint8_t>(type);
+    frame_types = active ? frame_types | bit : frame_types & ~bit;
+  }
+
+  /// Enables only the indicated frame types
+  void setFrameTypes(std::initializer_list<Frameype_t> types) {
+    frame_types = 0;
+    for (Frameype_t type : types) setFrameTypeActive(type, true);
+  }
+
+  /// Adds a PAN ID: the broadcast PAN 0xFFFF can not be added
+  bool addPanId(uint16_t panId) { return pans.add(panId); }
+
+  /// Adds a short (16 bit) address: the on air bytes as little endian value
+  bool addShortAddress(uint16_t address) {
+    return short_addresses.add(address);
+  }
+
+  /// Adds an extended (64 bit) address: bytes as on air
+  bool addExtendedAddress(const uint8_t* address) {
+    return extended_addresses.add(addressKey(address, 8));
+  }
+
+  /// Adds a short or extended address
+  bool addAddress(Address address) {
+    switch (address.mode()) {
+      case addr_mode_t::SHORT:
+        return short_addresses.add(address.key());
+      case addr_mode_t::EXTENDED:
+        return extended_addresses.add(address.key());
+      default:
+        return false;
+    }
+  }
+
+  /// Removes all entries and enables all frame types
+  void clear() {
+    pans.clear();
+    short_addresses.clear();
+    extended_addresses.clear();
+    frame_types = 0xFF;
+  }
+
+  /// Number of PAN ID and address entries
+  size_t size() const {
+    return pans.size() + short_addresses.size() + extended_addresses.size();
+  }
+
+  /// Evaluates the filter on a parsed frame
+  bool accepts(const FrameView& view) {
+    bool result = matches(view);
+    if (!result) dropped++;
+    return result;
+  }
+
+  /// Evaluates the filter on the raw frame (length byte followed by the PSDU)
+  bool accepts(const uint8_t* frame) {
+    FrameView view(frame);
+    return accepts(view);
+  }
+
+  /// Number of frames that were dropped by the filter
+  uint32_t droppedCount() const { return dropped; }
+
+ protected:
+  HashSet<uint16_t> pans;
+  HashSet<uint16_t> short_addresses;
+  HashSet<uint64_t> extended_addresses;
+  uint8_t frame_types = 0xFF;  // bit n: frame type n is accepted
+  uint32_t dropped = 0;
+
+  bool matches(const FrameView& view) const {
+    if (!view.isValid()) return false;
+    if (!(frame_types & (1 << view.frameType()))) return false;
+    if (!pans.isEmpty()) {
+      bool found =
+          (view.destAddrLen() > 0 && pans.contains(view.destPanId())) ||
+          (view.srcAddrLen() > 0 && pans.contains(view.srcPanId()));
+      if (!found) return false;
+    }
+    if (!short_addresses.isEmpty() || !extended_addresses.isEmpty()) {
+      if (!containsAddress(view.destAddress(), view.destAddrLen()) &&
+          !containsAddress(view.srcAddress(), view.srcAddrLen())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool containsAddress(const uint8_t* address, uint8_t len) const {
+    switch (len) {
+      case 2:
+        return short_addresses.contains(addressKey(address, 2));
+      case 8:
+        return extended_addresses.contains(addressKey(address, 8));
+      default:
+        return false;
+    }
+  }
+};
+
+}  // namespace ieee802154
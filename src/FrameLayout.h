@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Frame.h"
+#include "esp_log.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Compile-time description of a MAC header that does not change
+ * between frames.
+ *
+ * The addressing modes, PAN ID compression, ack request and sequence number
+ * suppression are template parameters, so the header size and the field offsets
+ * are constants. The header image is built once when the PAN or the addresses
+ * are set: building a frame is then a header memcpy, the sequence number and
+ * a payload memcpy.
+ *
+ * Example:
+ * @code
+ * FrameLayout<addr_mode_t::SHORT, addr_mode_t::SHORT> layout(0x1234, dest,
+ *                                                            local);
+ * transceiver.send(layout, data, len);
+ * @endcode
+ */
+template <addr_mode_t DestMode, addr_mode_t SrcMode,
+          bool PanIdCompression = true, bool AckRequest = false,
+          bool SequenceNumberSuppression = false,
+          Frameype_t FrameType = Frameype_t::DATA,
+          frame_version_t Version = frame_version_t::V_2006>
+class FrameLayout {
+  static_assert(DestMode != addr_mode_t::RESERVED &&
+                    SrcMode != addr_mode_t::RESERVED,
+                "Invalid address mode");
+
+ public:
+  /// Length of the destination address
+  static constexpr size_t DEST_ADDR_LEN = addressLength(DestMode);
+  /// Length of the source address
+  static constexpr size_t SRC_ADDR_LEN = addressLength(SrcMode);
+  static constexpr bool HAS_DEST_PAN = DEST_ADDR_LEN > 0;
+  static constexpr bool HAS_SRC_PAN = SRC_ADDR_LEN > 0 && !PanIdCompression;
+
+  /// Offsets in the header (without the length byte)
+  static constexpr size_t SEQ_OFFSET = IEEE802154_FCF_SIZE;
+  static constexpr size_t DEST_PAN_OFFSET =
+      SEQ_OFFSET + (SequenceNumberSuppression ? 0 : 1);
+  static constexpr size_t DEST_ADDR_OFFSET =
+      DEST_PAN_OFFSET + (HAS_DEST_PAN ? IEEE802154_PAN_ID_LEN : 0);
+  static constexpr size_t SRC_PAN_OFFSET = DEST_ADDR_OFFSET + DEST_ADDR_LEN;
+  static constexpr size_t SRC_ADDR_OFFSET =
+      SRC_PAN_OFFSET + (HAS_SRC_PAN ? IEEE802154_PAN_ID_LEN : 0);
+
+  /// Size of the MAC header
+  static constexpr size_t HEADER_SIZE = SRC_ADDR_OFFSET + SRC_ADDR_LEN;
+  /// Maximum payload size: 127 bytes PSDU minus header and FCS
+  static constexpr size_t MAX_PAYLOAD_SIZE = 127 - HEADER_SIZE - 2;
+
+  /// The Frame Control Field as 16 bit value
+  static constexpr uint16_t FCF =
+      static_cast<uint16_t>(FrameType) | (AckRequest ? 1 << 5 : 0) |
+      (PanIdCompression ? 1 << 6 : 0) | (SequenceNumberSuppression ? 1 << 8 : 0) |
+      static_cast<uint16_t>(DestMode) << 10 |
+      static_cast<uint16_t>(Version) << 12 | static_cast<uint16_t>(SrcMode)
+                                                  << 14;
+
+  FrameLayout() { setFrameControlField(); }
+
+  FrameLayout(uint16_t panId, Address destination, Address source) {
+    setFrameControlField();
+    setPAN(panId);
+    setDestinationAddress(destination);
+    setSourceAddress(source);
+  }
+
+  /// Provides the Frame Control Field as structure
+  static FrameControlField getFrameControlField() {
+    FrameControlField result;
+    uint8_t fcf[IEEE802154_FCF_SIZE] = {FCF & 0xFF, FCF >> 8};
+    memcpy(&result, fcf, IEEE802154_FCF_SIZE);
+    return result;
+  }
+
+  /// Defines the PAN ID
+  void setPAN(uint16_t panId) {
+    if constexpr (HAS_DEST_PAN) {
+      header[DEST_PAN_OFFSET] = panId & 0xFF;
+      header[DEST_PAN_OFFSET + 1] = panId >> 8;
+    }
+    if constexpr (HAS_SRC_PAN) {
+      header[SRC_PAN_OFFSET] = panId & 0xFF;
+      header[SRC_PAN_OFFSET + 1] = panId >> 8;
+    }
+  }
+
+  /// Defines the destination address: the mode must match DestMode
+  bool setDestinationAddress(Address address) {
+    if (address.mode() != DestMode) {
+      ESP_LOGE("FrameLayout", "Invalid destination address mode");
+      return false;
+    }
+    memcpy(header + DEST_ADDR_OFFSET, address.data(), DEST_ADDR_LEN);
+    return true;
+  }
+
+  /// Defines the source address: the mode must match SrcMode
+  bool setSourceAddress(Address address) {
+    if (address.mode() != SrcMode) {
+      ESP_LOGE("FrameLayout", "Invalid source address mode");
+      return false;
+    }
+    memcpy(header + SRC_ADDR_OFFSET, address.data(), SRC_ADDR_LEN);
+    return true;
+  }
+
+  /// Provides the prebuilt header image
+  const uint8_t* getHeader() const { return header; }
+
+  /**
+   * @brief Build the frame with the length byte at the start and 0x00 at the
+   * end (same format as Frame::build()).
+   * @param buffer Target buffer with space for MAX_FRAME_LEN bytes.
+   * @param sequenceNumber Sequence number (ignored if it is suppressed).
+   * @param payload Payload data.
+   * @param len Payload length: at most MAX_PAYLOAD_SIZE.
+   * @return Value of the length byte or 0 if the payload is too big.
+   */
+  size_t build(uint8_t* buffer, uint8_t sequenceNumber, const uint8_t* payload,
+               size_t len) const {
+    if (len > MAX_PAYLOAD_SIZE) return 0;
+    memcpy(buffer + 1, header, HEADER_SIZE);
+    if constexpr (!SequenceNumberSuppression) {
+      buffer[1 + SEQ_OFFSET] = sequenceNumber;
+    }
+    memcpy(buffer + 1 + HEADER_SIZE, payload, len);
+    buffer[1 + HEADER_SIZE + len] = 0x00;
+    buffer[0] = HEADER_SIZE + len + 2;
+    return buffer[0];
+  }
+
+ protected:
+  uint8_t header[HEADER_SIZE] = {0};
+
+  void setFrameControlField() {
+    header[0] = FCF & 0xFF;
+    header[1] = FCF >> 8;
+  }
+};
+
+}  // namespace ieee802154
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "Frame.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Lock-free single producer / single consumer queue of slot indexes.
+ *
+ * One side may only call push() and the other side may only call pop(), so
+ * that it can be used between an ISR and a task without any locking.
+ */
+class IndexQueue {
+ public:
+  void resize(size_t size) {
+    buffer.resize(size + 1);  // one slot is always kept empty
+    slots = buffer.data();
+    slots_len = size + 1;
+    clear();
+  }
+
+  /// Uses the provided memory: it needs space for size + 1 entries
+  void setStorage(uint16_t* data, size_t size) {
+    std::vector<uint16_t>().swap(buffer);
+    slots = data;
+    slots_len = size + 1;
+    clear();
+  }
+
+  void clear() {
+    head.store(0);
+    tail.store(0);
+  }
+
+  bool push(uint16_t index) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t next = (t + 1) % slots_len;
+    if (next == head.load(std::memory_order_acquire)) return false;
+    slots[t] = index;
+    tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(uint16_t& index) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) return false;
+    index = slots[h];
+    head.store((h + 1) % slots_len, std::memory_order_release);
+    return true;
+  }
+
+  bool isEmpty() const {
+    return head.load(std::memory_order_acquire) ==
+           tail.load(std::memory_order_acquire);
+  }
+
+ protected:
+  std::vector<uint16_t> buffer;  // used w/o external storage
+  uint16_t* slots = nullptr;
+  size_t slots_len = 0;
+  std::atomic<size_t> head{0};
+  std::atomic<size_t> tail{0};
+};
+
+/**
+ * @brief Pre-allocated pool of frame slots for zero-copy hand-off of received
+ * frames from the ISR to the consumer task.
+ *
+ * The producer (ISR) calls acquire() to get an empty slot, fills it and hands
+ * it over with publish(). The consumer gets the filled slots with receive() and
+ * gives them back with release() after processing. Empty and filled slots are
+ * passed by index through two lock-free SPSC queues, so the frame data is only
+ * copied once from the driver buffer into the slot.
+ *
+ * The slots are allocated by resize() or provided with setStorage().
+ */
+class FramePool {
+ public:
+  /// Allocates the slots: must not be called while frames are being received.
+  /// With external storage the count is limited to the provided slots.
+  void resize(size_t count) {
+    if (p_storage != nullptr) {
+      if (count > storage_count) count = storage_count;
+      frames = p_storage;
+      free_slots.setStorage(p_indexes, count);
+      ready_slots.setStorage(p_indexes + count + 1, count);
+    } else {
+      buffer.resize(count);
+      frames = buffer.data();
+      free_slots.resize(count);
+      ready_slots.resize(count);
+    }
+    frames_len = count;
+    for (size_t j = 0; j < count; j++) {
+      free_slots.push(j);
+    }
+  }
+
+  /**
+   * @brief Uses the provided memory instead of the heap: must not be called
+   * while frames are being received.
+   * @param data Memory for count slots.
+   * @param indexes Memory for 2 * (count + 1) entries.
+   * @param count Number of slots.
+   */
+  void setStorage(frame_data_t* data, uint16_t* indexes, size_t count) {
+    std::vector<frame_data_t>().swap(buffer);
+    p_storage = data;
+    p_indexes = indexes;
+    storage_count = count;
+    resize(count);
+  }
+
+  /// Number of slots in the pool
+  size_t size() const { return frames_len; }
+
+  /// Producer: provides an empty slot or nullptr if all slots are in use
+  frame_data_t* acquire() {
+    uint16_t index;
+    if (!free_slots.pop(index)) return nullptr;
+    return &frames[index];
+  }
+
+  /// Producer: hands over a filled slot to the consumer
+  bool publish(frame_data_t* slot) { return ready_slots.push(indexOf(slot)); }
+
+  /// Consumer: provides the next filled slot or nullptr if there is none
+  frame_data_t* receive() {
+    uint16_t index;
+    if (!ready_slots.pop(index)) return nullptr;
+    return &frames[index];
+  }
+
+  /// Consumer: gives a processed slot back to the producer
+  void release(frame_data_t* slot) {
+    if (slot != nullptr) free_slots.push(indexOf(slot));
+  }
+
+  /// Returns true if there is no filled slot waiting for the consumer
+  bool isEmpty() const { return ready_slots.isEmpty(); }
+
+ protected:
+  std::vector<frame_data_t> buffer;  // used w/o external storage
+  frame_data_t* frames = nullptr;
+  size_t frames_len = 0;
+  frame_data_t* p_storage = nullptr;  // external storage
+  uint16_t* p_indexes = nullptr;
+  size_t storage_count = 0;
+  IndexQueue free_slots;   // producer: release(), consumer: acquire()
+  IndexQueue ready_slots;  // producer: publish(), consumer: receive()
+
+  uint16_t indexOf(frame_data_t* slot) const { return slot - frames; }
+};
+
+}  // namespace ieee802154
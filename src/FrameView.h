@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Frame.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Lightweight read-only view of a raw IEEE 802.15.4 frame.
+ *
+ * In contrast to Frame, nothing is copied: the view keeps a pointer to the
+ * frame data (length byte followed by the PSDU) and only determines the field
+ * offsets from the Frame Control Field. The fields are decoded on demand, so
+ * that sniffers and filters that only look at e.g. the frame type or the
+ * destination pay for nothing else.
+ *
+ * The frame data must stay valid as long as the view is used.
+ */
+class FrameView {
+ public:
+  FrameView() = default;
+
+  /// Creates a view on the frame data (length byte followed by the PSDU)
+  explicit FrameView(const uint8_t* data) { parse(data); }
+
+  /**
+   * @brief Determines the field offsets of the frame
+   * @param data Frame data with the length byte at the start.
+   * @return false if the frame is too short for its header.
+   */
+  bool parse(const uint8_t* data) {
+    p_data = data;
+    valid = false;
+    if (data == nullptr) return false;
+    // same end as Frame::parse(): the payload ends before the FCS
+    end = data[0] - 1;
+    if (data[0] < 1 || data[0] >= MAX_FRAME_LEN) return false;
+    if (1 + IEEE802154_FCF_SIZE > end) return false;
+    uint8_t fcf_hi = data[2];
+    bool seq_suppressed = fcf_hi & 0x01;
+    dest_len = addressLength(static_cast<addr_mode_t>((fcf_hi >> 2) & 0x03));
+    src_len = addressLength(static_cast<addr_mode_t>((fcf_hi >> 6) & 0x03));
+    size_t offset = 1 + IEEE802154_FCF_SIZE;
+    seq_offset = seq_suppressed ? 0 : offset;
+    if (!seq_suppressed) offset++;
+    dest_pan_offset = dest_len > 0 ? offset : 0;
+    if (dest_len > 0) offset += IEEE802154_PAN_ID_LEN;
+    dest_offset = offset;
+    offset += dest_len;
+    bool src_pan = src_len > 0 && !(data[1] & 0x40);
+    src_pan_offset = src_pan ? offset : dest_pan_offset;
+    if (src_pan) offset += IEEE802154_PAN_ID_LEN;
+    src_offset = offset;
+    offset += src_len;
+    if (offset > end) return false;
+    payload_offset = offset;
+    valid = true;
+    return true;
+  }
+
+  /// Returns true if the last parse() was successful
+  bool isValid() const { return valid; }
+
+  /// Provides the frame data (length byte followed by the PSDU)
+  const uint8_t* data() const { return p_data; }
+
+  /// Frame Control Field
+  FrameControlField fcf() const {
+    FrameControlField result;
+    memcpy(&result, p_data + 1, IEEE802154_FCF_SIZE);
+    return result;
+  }
+
+  /// Frame type (see Frameype_t)
+  uint8_t frameType() const { return p_data[1] & 0x07; }
+
+  /// Returns true if the sender requested an acknowledgment
+  bool isAckRequest() const { return p_data[1] & 0x20; }
+
+  /// Sequence number or 0 if it is suppressed
+  uint8_t sequenceNumber() const {
+    return seq_offset ? p_data[seq_offset] : 0;
+  }
+
+  /// Returns true if the sequence number is present
+  bool hasSequenceNumber() const { return seq_offset != 0; }
+
+  /// Destination PAN ID or 0 if there is no destination address
+  uint16_t destPanId() const { return readPanId(dest_pan_offset); }
+
+  /// Destination address (little endian as on air)
+  const uint8_t* destAddress() const { return p_data + dest_offset; }
+
+  /// Length of the destination address: 0, 2 or 8
+  uint8_t destAddrLen() const { return dest_len; }
+
+  /// Source PAN ID: the destination PAN ID if it is compressed
+  uint16_t srcPanId() const {
+    return src_len > 0 ? readPanId(src_pan_offset) : 0;
+  }
+
+  /// Source address (little endian as on air)
+  const uint8_t* srcAddress() const { return p_data + src_offset; }
+
+  /// Length of the source address: 0, 2 or 8
+  uint8_t srcAddrLen() const { return src_len; }
+
+  /// Payload data
+  const uint8_t* payload() const { return p_data + payload_offset; }
+
+  /// Length of the payload (without FCS)
+  size_t payloadLen() const { return end - payload_offset; }
+
+  /// Length of the MAC header
+  size_t headerLen() const { return payload_offset - 1; }
+
+ protected:
+  const uint8_t* p_data = nullptr;
+  bool valid = false;
+  uint8_t end = 0;
+  uint8_t seq_offset = 0;  // 0 if not present
+  uint8_t dest_pan_offset = 0;  // 0 if not present
+  uint8_t dest_offset = 0;
+  uint8_t dest_len = 0;
+  uint8_t src_pan_offset = 0;  // 0 if not present
+  uint8_t src_offset = 0;
+  uint8_t src_len = 0;
+  uint8_t payload_offset = 0;
+
+  uint16_t readPanId(uint8_t offset) const {
+    return offset ? (p_data[offset + 1] << 8) | p_data[offset] : 0;
+  }
+};
+
+}  // namespace ieee802154
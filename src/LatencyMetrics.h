@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace ieee802154 {
+
+/**
+ * @brief Histogram of latencies in microseconds with log-linear buckets.
+ *
+ * Values below 16 us have their own bucket, above each power of 2 range is
+ * split into 8 buckets, so a percentile is accurate to 12.5%. The minimum,
+ * maximum and mean are exact. Values above about 16 s are counted in the last
+ * bucket. The histogram needs no heap and add() is a few shifts.
+ */
+class LatencyHistogram {
+ public:
+  /// Number of buckets
+  static constexpr int BUCKETS = 176;
+
+  /// Adds a latency in microseconds
+  void add(uint32_t us) {
+    int idx = bucket(us);
+    buckets[idx < BUCKETS ? idx : BUCKETS - 1]++;
+    if (n == 0 || us < min_us) min_us = us;
+    if (us > max_us) max_us = us;
+    total_us += us;
+    n++;
+  }
+
+  /// Number of values
+  uint32_t count() const { return n; }
+
+  /// Minimum latency
+  uint32_t minUs() const { return min_us; }
+
+  /// Maximum latency
+  uint32_t maxUs() const { return max_us; }
+
+  /// Average latency
+  uint32_t meanUs() const { return n == 0 ? 0 : total_us / n; }
+
+  /**
+   * @brief Latency below which the indicated share of the values are
+   * @param percent e.g. 99 for the p99 latency
+   * @return upper bound of the bucket, limited to the maximum
+   */
+  uint32_t percentileUs(float percent) const {
+    if (n == 0) return 0;
+    uint32_t rank = (uint32_t)(percent / 100.0f * n + 0.999f);
+    if (rank < 1) rank = 1;
+    uint32_t sum = 0;
+    for (int j = 0; j < BUCKETS; j++) {
+      sum += buckets[j];
+      if (sum >= rank) {
+        uint32_t result = upperBound(j);
+        return result < max_us ? result : max_us;
+      }
+    }
+    return max_us;
+  }
+
+  /// Number of values in the bucket
+  uint32_t bucketCount(int idx) const { return buckets[idx]; }
+
+  /// Largest value that is counted in the bucket
+  static uint32_t upperBound(int idx) {
+    if (idx < 16) return idx;
+    int exp = (idx - 16) / 8 + 4;
+    uint32_t sub = (idx - 16) % 8;
+    return ((8 + sub + 1) << (exp - 3)) - 1;
+  }
+
+  /// Removes all values
+  void reset() {
+    memset(buckets, 0, sizeof(buckets));
+    n = 0;
+    min_us = max_us = 0;
+    total_us = 0;
+  }
+
+ protected:
+  uint32_t buckets[BUCKETS] = {0};
+  uint32_t n = 0;
+  uint32_t min_us = 0;
+  uint32_t max_us = 0;
+  uint64_t total_us = 0;
+
+  static int bucket(uint32_t us) {
+    if (us < 16) return us;
+    int exp = 31 - __builtin_clz(us);  // >= 4
+    return 16 + (exp - 4) * 8 + ((us >> (exp - 3)) & 7);
+  }
+};
+
+/**
+ * @brief Latencies of the received frames along the receive path.
+ *
+ * For each frame the following times are taken: the radio timestamp from
+ * esp_ieee802154_frame_info_t (esp_timer time of the reception), the time it
+ * was queued in the ISR, the time the receive task took it from the queue and
+ * the start and end of the rx callback. They are aggregated into the
+ * histograms of the stages in between and of the total latency.
+ *
+ * The histograms are updated by the receive task: read them from another task
+ * only for reporting, as the values of a frame can be partially updated.
+ */
+struct LatencyMetrics {
+  LatencyHistogram radio_to_isr;  // radio timestamp to queueing in the ISR
+  LatencyHistogram queue;         // ISR queueing to dequeue by the task
+  LatencyHistogram dispatch;      // dequeue to callback start (parsing)
+  LatencyHistogram callback;      // callback start to callback end
+  LatencyHistogram end_to_end;    // radio timestamp to callback start
+
+  /// Adds the times (esp_timer microseconds) of a received frame
+  void add(uint64_t radioUs, uint32_t isrUs, uint32_t dequeueUs,
+           uint32_t callbackStartUs, uint32_t callbackEndUs) {
+    // the radio timestamp is missing if it is 0
+    if (radioUs != 0) {
+      radio_to_isr.add(isrUs - (uint32_t)radioUs);
+      end_to_end.add(callbackStartUs - (uint32_t)radioUs);
+    }
+    queue.add(dequeueUs - isrUs);
+    dispatch.add(callbackStartUs - dequeueUs);
+    callback.add(callbackEndUs - callbackStartUs);
+  }
+
+  /// Removes all values
+  void reset() {
+    radio_to_isr.reset();
+    queue.reset();
+    dispatch.reset();
+    callback.reset();
+    end_to_end.reset();
+  }
+};
+
+}  // namespace ieee802154
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <string.h>
+
+#ifdef ARDUINO
+#include "Arduino.h"
+#endif
+#include "Frame.h"
+#include "RingBuffer.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Writes received frames as pcapng capture that can be opened with
+ * Wireshark.
+ *
+ * The frames are stored with the link type LINKTYPE_IEEE802_15_4_TAP: each
+ * frame is preceded by a TAP header with the RSSI, LQI, channel and the start
+ * of frame (SFD) timestamp from esp_ieee802154_frame_info_t, which is also
+ * the timestamp of the packet (see rxFrameStartUs()). The FCS is not
+ * captured.
+ *
+ * The binary blocks are appended to a lock-free single producer / single
+ * consumer ring buffer without any formatting, so one task can add the frames
+ * while another task drains the capture to any Arduino Print (e.g. Serial or
+ * a File) with drain() or reads it with readBytes(). A frame is only added
+ * if its whole block fits into the buffer: otherwise it is dropped and
+ * counted.
+ *
+ * Example:
+ * @code
+ * PcapngWriter capture;
+ * capture.begin();
+ * // receive task
+ * capture.write(*packet);
+ * // loop
+ * capture.drain(Serial);
+ * @endcode
+ */
+class PcapngWriter {
+ public:
+  /// LINKTYPE_IEEE802_15_4_TAP
+  static constexpr uint16_t LINKTYPE = 283;
+  /// Size of the TAP header with all TLVs
+  static constexpr size_t TAP_HEADER_SIZE = 48;
+  /// Maximum size of an Enhanced Packet Block
+  static constexpr size_t MAX_BLOCK_SIZE = 32 + TAP_HEADER_SIZE + MAX_FRAME_LEN;
+
+  PcapngWriter(size_t bufferSize = 4096) : buffer(bufferSize) {}
+
+  /// Changes the size of the capture buffer: call before begin()
+  void setBufferSize(size_t size) { buffer.resize(size); }
+
+  /// Uses the provided memory for the capture buffer
+  void setBufferStorage(uint8_t* data, size_t size) {
+    buffer.setStorage(data, size);
+  }
+
+  /// Starts a new capture: adds the section header and interface blocks
+  bool begin() {
+    buffer.clear();
+    dropped = 0;
+    captured = 0;
+    uint8_t block[SHB_SIZE + IDB_SIZE];
+    uint8_t* out = block;
+    // Section Header Block
+    out = put32(out, SHB_TYPE);
+    out = put32(out, SHB_SIZE);
+    out = put32(out, BYTE_ORDER_MAGIC);
+    out = put16(out, 1);  // major version
+    out = put16(out, 0);  // minor version
+    out = put32(out, 0xFFFFFFFF);  // section length: not specified
+    out = put32(out, 0xFFFFFFFF);
+    out = put32(out, SHB_SIZE);
+    // Interface Description Block
+    out = put32(out, IDB_TYPE);
+    out = put32(out, IDB_SIZE);
+    out = put16(out, LINKTYPE);
+    out = put16(out, 0);  // reserved
+    out = put32(out, MAX_FRAME_LEN);  // snap length
+    out = put16(out, 9);  // if_tsresol: microseconds
+    out = put16(out, 1);
+    out = put32(out, 6);  // value and padding
+    out = put32(out, 0);  // opt_endofopt
+    out = put32(out, IDB_SIZE);
+    return addBlock(block, out - block);
+  }
+
+  /// Adds a received frame (length byte followed by the PSDU)
+  bool write(const uint8_t* frame, const esp_ieee802154_frame_info_t& info) {
+    // the PSDU without the 2 FCS bytes
+    size_t len = frame[0] >= 2 && frame[0] < MAX_FRAME_LEN ? frame[0] - 2 : 0;
+    size_t data_len = TAP_HEADER_SIZE + len;
+    size_t padded_len = (data_len + 3) & ~3;
+    size_t block_len = 32 + padded_len;
+    uint8_t block[MAX_BLOCK_SIZE];
+    uint8_t* out = block;
+    // Enhanced Packet Block
+    uint64_t timestamp = info.timestamp;
+    out = put32(out, EPB_TYPE);
+    out = put32(out, block_len);
+    out = put32(out, 0);  // interface id
+    out = put32(out, timestamp >> 32);
+    out = put32(out, timestamp & 0xFFFFFFFF);
+    out = put32(out, data_len);  // captured length
+    out = put32(out, data_len);  // original length
+    // TAP header
+    out = put8(out, 0);  // version
+    out = put8(out, 0);  // reserved
+    out = put16(out, TAP_HEADER_SIZE);
+    out = putTlv(out, TLV_FCS_TYPE, 1, 0);  // no FCS
+    float rssi = info.rssi;
+    uint32_t rssi_bits;
+    memcpy(&rssi_bits, &rssi, sizeof(rssi_bits));
+    out = putTlv(out, TLV_RSS, 4, rssi_bits);
+    out = putTlv(out, TLV_CHANNEL, 3, info.channel);  // page 0
+    out = putTlv(out, TLV_LQI, 1, info.lqi);
+    out = put16(out, TLV_SOF_TS);
+    out = put16(out, 8);
+    uint64_t timestamp_ns = timestamp * 1000;
+    out = put32(out, timestamp_ns & 0xFFFFFFFF);
+    out = put32(out, timestamp_ns >> 32);
+    // Frame
+    memcpy(out, frame + 1, len);
+    out += len;
+    while ((out - block) % 4 != 0) *out++ = 0;
+    out = put32(out, block_len);
+    if (!addBlock(block, out - block)) {
+      dropped++;
+      return false;
+    }
+    captured++;
+    return true;
+  }
+
+  /// Adds a received frame with its frame info
+  bool write(const frame_data_t& packet) {
+    return write(packet.frame, packet.frame_info);
+  }
+
+#ifdef ARDUINO
+  /**
+   * @brief Writes the captured data to the output: the contiguous parts of
+   * the buffer are written with a single write() call each.
+   * @param out Target e.g. Serial or a File.
+   * @return Number of bytes that were written.
+   */
+  size_t drain(Print& out) {
+    size_t result = 0;
+    const uint8_t* data = nullptr;
+    size_t len = buffer.getReadSpan(data);
+    while (len > 0) {
+      size_t written = out.write(data, len);
+      buffer.consume(written);
+      result += written;
+      if (written < len) break;
+      len = buffer.getReadSpan(data);
+    }
+    return result;
+  }
+#endif
+
+  /// Reads up to len bytes of the captured data: returns the number of bytes
+  size_t readBytes(uint8_t* data, size_t len) {
+    return buffer.readArray(data, len);
+  }
+
+  /// Number of bytes that are waiting to be drained
+  size_t available() const { return buffer.available(); }
+
+  /// Number of frames that were added
+  uint32_t capturedCount() const { return captured; }
+
+  /// Number of frames that were dropped because the buffer was full
+  uint32_t droppedCount() const { return dropped; }
+
+ protected:
+  static constexpr uint32_t SHB_TYPE = 0x0A0D0D0A;
+  static constexpr uint32_t IDB_TYPE = 0x00000001;
+  static constexpr uint32_t EPB_TYPE = 0x00000006;
+  static constexpr uint32_t BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+  static constexpr size_t SHB_SIZE = 28;
+  static constexpr size_t IDB_SIZE = 32;
+  // TAP TLV types
+  static constexpr uint16_t TLV_FCS_TYPE = 0;
+  static constexpr uint16_t TLV_RSS = 1;
+  static constexpr uint16_t TLV_CHANNEL = 3;
+  static constexpr uint16_t TLV_SOF_TS = 5;
+  static constexpr uint16_t TLV_LQI = 10;
+  SPSCRingBuffer buffer;
+  uint32_t captured = 0;
+  uint32_t dropped = 0;
+
+  bool addBlock(const uint8_t* block, size_t len) {
+    if ((size_t)buffer.availableForWrite() < len) return false;
+    buffer.writeArray(block, len);
+    return true;
+  }
+
+  static uint8_t* put8(uint8_t* out, uint8_t value) {
+    *out = value;
+    return out + 1;
+  }
+
+  static uint8_t* put16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+    return out + 2;
+  }
+
+  static uint8_t* put32(uint8_t* out, uint32_t value) {
+    out = put16(out, value & 0xFFFF);
+    return put16(out, value >> 16);
+  }
+
+  /// TLV with a value of up to 4 bytes, padded to 4 bytes
+  static uint8_t* putTlv(uint8_t* out, uint16_t type, uint16_t len,
+                         uint32_t value) {
+    out = put16(out, type);
+    out = put16(out, len);
+    return put32(out, value);
+  }
+};
+
+}  // namespace ieee802154
@@ -0,0 +1,353 @@
+#include "RadioDispatcher.h"
+
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "FrameView.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// tag for logging
+#define TAG "IEEE802154_DISPATCHER"
+
+namespace ieee802154 {
+
+/// accessible by global callback functions
+static RadioDispatcher radio_dispatcher;
+
+RadioDispatcher& RadioDispatcher::instance() { return radio_dispatcher; }
+
+bool RadioDispatcher::add(ESP32TransceiverIEEE802_15_4* endpoint) {
+  for (int j = 0; j < count; j++) {
+    if (endpoints[j] == endpoint) return true;
+  }
+  if (count >= MAX_ENDPOINTS) {
+    ESP_LOGE(TAG, "Too many endpoints: max %d", MAX_ENDPOINTS);
+    return false;
+  }
+  // a shared radio is promiscuous and does not send any acknowledgments
+  if (count > 0) {
+    for (int j = 0; j <= count; j++) {
+      ESP32TransceiverIEEE802_15_4* other = j < count ? endpoints[j] : endpoint;
+      if (!other->is_promiscuous_mode &&
+          other->frame_control_field.ackRequest) {
+        ESP_LOGE(TAG,
+                 "Endpoint %s requests acknowledgments: it can not share the "
+                 "radio with other endpoints",
+                 other->local_address.to_str());
+        return false;
+      }
+    }
+  }
+  portENTER_CRITICAL(&tx_lock);
+  endpoints[count++] = endpoint;
+  portEXIT_CRITICAL(&tx_lock);
+  return true;
+}
+
+void RadioDispatcher::remove(ESP32TransceiverIEEE802_15_4* endpoint) {
+  portENTER_CRITICAL(&tx_lock);
+  for (int j = 0; j < count; j++) {
+    if (endpoints[j] == endpoint) {
+      for (int k = j + 1; k < count; k++) {
+        endpoints[k - 1] = endpoints[k];
+      }
+      endpoints[--count] = nullptr;
+      break;
+    }
+  }
+  // the frame on air stays owned by the endpoint until it is completed, but
+  // the completion is not reported to it any more
+  if (tx_owner == endpoint) tx_owner_removed = true;
+  portEXIT_CRITICAL(&tx_lock);
+}
+
+// Internal: Number of registered endpoints that are not promiscuous
+int RadioDispatcher::filteredCount() const {
+  int result = 0;
+  for (int j = 0; j < count; j++) {
+    if (!endpoints[j]->is_promiscuous_mode) result++;
+  }
+  return result;
+}
+
+// Internal: Defines the radio configuration and filter for the registered
+// endpoints
+bool RadioDispatcher::updateFilter() {
+  if (count == 0) return true;
+  bool coordinator = false;
+  bool rx_when_idle = false;
+  // the hardware filter is only used for a single endpoint that is not
+  // promiscuous: a sniffer next to it captures all frames
+  ESP32TransceiverIEEE802_15_4* filtered = nullptr;
+  for (int j = 0; j < count; j++) {
+    ESP32TransceiverIEEE802_15_4* endpoint = endpoints[j];
+    if (endpoint->is_coordinator) coordinator = true;
+    if (endpoint->is_rx_when_idle) rx_when_idle = true;
+    if (!endpoint->is_promiscuous_mode && filtered == nullptr) {
+      filtered = endpoint;
+    }
+  }
+  int filtered_count = filteredCount();
+  bool promiscuous = count > 1 || filtered_count == 0;
+  software_filter = count > 1;
+  if (software_filter && filtered_count > 0) {
+    ESP_LOGW(TAG,
+             "%d endpoints share the radio: filtering in software, the "
+             "radio does not send acknowledgments",
+             count);
+  }
+
+  if (esp_ieee802154_set_coordinator(coordinator) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to set coordinator mode to %s",
+             coordinator ? "true" : "false");
+    return false;
+  }
+  if (esp_ieee802154_set_rx_when_idle(rx_when_idle) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to set rx when idle to %s",
+             rx_when_idle ? "true" : "false");
+    return false;
+  }
+  ESP_LOGI(TAG, "Setting promiscuous mode to %s for %d endpoint(s)",
+           promiscuous ? "true" : "false", count);
+  if (esp_ieee802154_set_promiscuous(promiscuous) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to set promiscuous mode");
+    return false;
+  }
+
+  if (!promiscuous) {
+    ESP_LOGI(TAG, "Setting PAN ID to 0x%04X", filtered->panID);
+    if (esp_ieee802154_set_panid(filtered->panID) != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to set PAN ID: %d", filtered->panID);
+      return false;
+    }
+    esp_err_t ret = ESP_OK;
+    ESP_LOGI(TAG, "Setting local address: %s",
+             filtered->local_address.to_str());
+    if (filtered->local_address.mode() == addr_mode_t::SHORT) {
+      ret = esp_ieee802154_set_short_address(
+          *(uint16_t*)filtered->local_address.data());
+    } else if (filtered->local_address.mode() == addr_mode_t::EXTENDED) {
+      ret = esp_ieee802154_set_extended_address(
+          filtered->local_address.data());
+    }
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to set local address: %d", ret);
+      return false;
+    }
+  }
+
+  // the settings are applied when receiving starts: during a transmission
+  // they are applied with the next receive
+  if (tx_owner == nullptr && esp_ieee802154_receive() != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to start receiving");
+    return false;
+  }
+  return true;
+}
+
+// Internal: Records the channel of the radio in all endpoints
+void RadioDispatcher::updateChannel(channel_t channel) {
+  portENTER_CRITICAL_SAFE(&tx_lock);
+  for (int j = 0; j < count; j++) endpoints[j]->channel = channel;
+  portEXIT_CRITICAL_SAFE(&tx_lock);
+}
+
+// Internal: Endpoint that owns the frame on air, nullptr if it was removed
+ESP32TransceiverIEEE802_15_4* RadioDispatcher::activeTxOwner() {
+  portENTER_CRITICAL_SAFE(&tx_lock);
+  ESP32TransceiverIEEE802_15_4* result = tx_owner_removed ? nullptr : tx_owner;
+  portEXIT_CRITICAL_SAFE(&tx_lock);
+  return result;
+}
+
+// Internal: Next endpoint with queued frames after the previous owner, so
+// that the endpoints are served round robin. Must be called with the tx_lock.
+ESP32TransceiverIEEE802_15_4* RadioDispatcher::nextTxOwner(
+    ESP32TransceiverIEEE802_15_4* previous) {
+  int start = 0;
+  for (int j = 0; j < count; j++) {
+    if (endpoints[j] == previous) start = j + 1;
+  }
+  for (int j = 0; j < count; j++) {
+    ESP32TransceiverIEEE802_15_4* endpoint = endpoints[(start + j) % count];
+    if (endpoint->tx_count > 0) return endpoint;
+  }
+  return nullptr;
+}
+
+// Internal: Starts the next queued frame if the radio is idle
+void RadioDispatcher::startTx() {
+  portENTER_CRITICAL(&tx_lock);
+  ESP32TransceiverIEEE802_15_4* next = nullptr;
+  if (tx_owner == nullptr) {
+    next = nextTxOwner(nullptr);
+    tx_owner = next;
+  }
+  portEXIT_CRITICAL(&tx_lock);
+  if (next == nullptr) return;
+  if (transmit(next) != ESP_OK) {
+    completeTx(ESP_IEEE802154_TX_ERR_ABORT);
+  }
+}
+
+// Internal: Transmits the first queued frame of the endpoint with the TX
+// power that was selected for the frame
+esp_err_t RadioDispatcher::transmit(ESP32TransceiverIEEE802_15_4* endpoint) {
+  const tx_slot_t& slot = endpoint->tx_queue[endpoint->tx_head];
+  int8_t power = slot.tx_power;
+  if (power != TX_POWER_UNCHANGED && base_tx_power == TX_POWER_UNCHANGED) {
+    // remember the power for the frames without power control
+    base_tx_power = radio_tx_power = esp_ieee802154_get_txpower();
+  }
+  if (power == TX_POWER_UNCHANGED) power = base_tx_power;
+  if (power != TX_POWER_UNCHANGED && power != radio_tx_power) {
+    if (esp_ieee802154_set_txpower(power) == ESP_OK) radio_tx_power = power;
+  }
+  return esp_ieee802154_transmit(slot.frame, endpoint->cca_enabled);
+}
+
+// Internal: Removes the transmitted frame from the queue of its endpoint,
+// reports the completion and starts the transmission of the next queued frame
+void RadioDispatcher::completeTx(esp_ieee802154_tx_error_t error) {
+  while (true) {
+    uint32_t token = 0;
+    size_t len = 0;
+    ESP32TransceiverIEEE802_15_4* owner = nullptr;
+    ESP32TransceiverIEEE802_15_4* next = nullptr;
+    portENTER_CRITICAL_ISR(&tx_lock);
+    owner = tx_owner_removed ? nullptr : tx_owner;
+    tx_owner_removed = false;
+    if (owner != nullptr && owner->tx_count > 0) {
+      token = owner->tx_queue[owner->tx_head].token;
+      len = owner->tx_queue[owner->tx_head].frame[0];
+      owner->tx_head = (owner->tx_head + 1) % owner->tx_queue_len;
+      owner->tx_count--;
+    }
+    next = nextTxOwner(owner);
+    tx_owner = next;
+    portEXIT_CRITICAL_ISR(&tx_lock);
+
+    if (token != 0) {
+      owner->stats.addTx(error, len);
+      if (owner->tx_complete_callback_) {
+        owner->tx_complete_callback_(token, error,
+                                     owner->tx_complete_callback_user_data_);
+      }
+    }
+
+    // Keep the radio busy with the next frame
+    if (next == nullptr) return;
+    if (transmit(next) == ESP_OK) return;
+    error = ESP_IEEE802154_TX_ERR_ABORT;
+  }
+}
+
+void RadioDispatcher::onRxDone(uint8_t* frame,
+                               esp_ieee802154_frame_info_t* frame_info) {
+  ESP_LOGD(TAG, "Received frame with length %d, RSSI: %d, LQI: %d", frame[0],
+           frame_info->rssi, frame_info->lqi);
+  uint32_t rx_time_us = esp_timer_get_time();
+  BaseType_t higher_priority_task_woken = pdFALSE;
+
+  // Parse the frame at most once for all endpoints
+  FrameView view;
+  bool parsed = false;
+  for (int j = 0; j < count; j++) {
+    ESP32TransceiverIEEE802_15_4* endpoint = endpoints[j];
+    FrameFilter* filter = endpoint->p_frame_filter;
+    if (!parsed && (software_filter || filter != nullptr)) {
+      view.parse(frame);
+      parsed = true;
+    }
+    if (software_filter && !endpoint->acceptsFrame(view)) continue;
+    if (filter != nullptr && !filter->accepts(view)) continue;
+    endpoint->receiveFromISR(frame, frame_info, rx_time_us,
+                             &higher_priority_task_woken);
+  }
+
+  // Handle receive done to free internal buffers
+  if (esp_ieee802154_receive_handle_done(frame) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to handle receive done");
+  }
+
+  if (higher_priority_task_woken) {
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+  }
+}
+
+void RadioDispatcher::onTransmitDone(
+    const uint8_t* frame, const uint8_t* ack,
+    esp_ieee802154_frame_info_t* ack_frame_info) {
+  ESP32TransceiverIEEE802_15_4* owner = activeTxOwner();
+  if (owner) owner->onTransmitDone(frame, ack, ack_frame_info);
+  // Free internal buffers after transmission
+  if (ack) esp_ieee802154_receive_handle_done(ack);
+  completeTx(ESP_IEEE802154_TX_ERR_NONE);
+}
+
+void RadioDispatcher::onTransmitFailed(const uint8_t* frame,
+                                       esp_ieee802154_tx_error_t error) {
+  ESP32TransceiverIEEE802_15_4* owner = activeTxOwner();
+  if (owner) owner->onTransmitFailed(frame, error);
+  completeTx(error);
+}
+
+void RadioDispatcher::onStartFrameDelimiterReceived() {
+  for (int j = 0; j < count; j++) {
+    endpoints[j]->onStartFrameDelimiterReceived();
+  }
+}
+
+void RadioDispatcher::onStartFrameDelimiterTransmitDone(uint8_t* frame) {
+  ESP32TransceiverIEEE802_15_4* owner = activeTxOwner();
+  if (owner) owner->onStartFrameDelimiterTransmitDone(frame);
+}
+
+void RadioDispatcher::onEnergyDetectDone(int8_t power) {
+  if (energy_detect_callback) {
+    energy_detect_callback(power, energy_detect_user_data);
+  }
+}
+
+}  // namespace ieee802154
+
+using ieee802154::RadioDispatcher;
+
+// The SFD (Start Frame Delimiter) of the frame was received.
+extern "C" void esp_ieee802154_receive_sfd_done(void) {
+  ESP_LOGD(TAG, "esp_ieee802154_receive_sfd_done");
+  RadioDispatcher::instance().onStartFrameDelimiterReceived();
+}
+
+// Callback for received IEEE 802.15.4 frames.
+extern "C" void esp_ieee802154_receive_done(
+    uint8_t* frame, esp_ieee802154_frame_info_t* frame_info) {
+  ESP_LOGD(TAG, "esp_ieee802154_receive_done");
+  RadioDispatcher::instance().onRxDone(frame, frame_info);
+}
+
+// The Frame Transmission succeeded.
+extern "C" void esp_ieee802154_transmit_done(
+    const uint8_t* frame, const uint8_t* ack,
+    esp_ieee802154_frame_info_t* ack_frame_info) {
+  ESP_LOGD(TAG, "esp_ieee802154_transmit_done");
+  RadioDispatcher::instance().onTransmitDone(frame, ack, ack_frame_info);
+}
+
+// The Frame Transmission failed.
+extern "C" void esp_ieee802154_transmit_failed(
+    const uint8_t* frame, esp_ieee802154_tx_error_t error) {
+  ESP_LOGD(TAG, "esp_ieee802154_transmit_failed");
+  RadioDispatcher::instance().onTransmitFailed(frame, error);
+}
+
+// The SFD field of the frame was transmitted.
+extern "C" void esp_ieee802154_transmit_sfd_done(uint8_t* frame) {
+  ESP_LOGD(TAG, "esp_ieee802154_transmit_sfd_done");
+  RadioDispatcher::instance().onStartFrameDelimiterTransmitDone(frame);
+}
+
+// The energy detection finished.
+extern "C" void esp_ieee802154_energy_detect_done(int8_t power) {
+  ESP_LOGD(TAG, "esp_ieee802154_energy_detect_done");
+  RadioDispatcher::instance().onEnergyDetectDone(power);
+}
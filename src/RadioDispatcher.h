@@ -0,0 +1,118 @@
+#pragma once
+
+#include "esp_ieee802154.h"
+#include "freertos/FreeRTOS.h"
+
+namespace ieee802154 {
+
+// forward declaration
+class ESP32TransceiverIEEE802_15_4;
+class ChannelHopper;
+enum class channel_t : uint8_t;
+
+/**
+ * @brief Callback for the result of esp_ieee802154_energy_detect().
+ * @param power The detected energy in dBm.
+ * @param user_data User data pointer.
+ */
+typedef void (*energy_detect_callback_t)(int8_t power, void* user_data);
+
+/**
+ * @brief Shares the single IEEE 802.15.4 radio between several transceiver
+ * objects (endpoints).
+ *
+ * The ESP-IDF driver callbacks are global: the dispatcher routes them to the
+ * registered endpoints. A received frame is parsed once and is copied into
+ * the RX queue of each endpoint whose PAN / address filter accepts it. The TX
+ * queues of the endpoints are served round robin with one frame on air at a
+ * time, and the completion is reported to the endpoint that sent the frame.
+ *
+ * An endpoint registers in begin() and unregisters in end(). The first
+ * endpoint enables the radio and the last one disables it. All endpoints
+ * share the channel of the radio: an endpoint that is started with a
+ * different channel uses the channel of the radio. The radio is a
+ * coordinator and receives when idle if any endpoint requests it.
+ *
+ * The hardware filter and the automatic acknowledgments are only used when
+ * a single endpoint that is not promiscuous is registered. With several
+ * endpoints the radio runs in promiscuous mode, so that a promiscuous
+ * endpoint (sniffer) captures all frames, and the other endpoints filter the
+ * frames in software. The radio does not send acknowledgments in this case:
+ * an endpoint that requests acknowledgments can not share the radio.
+ */
+class RadioDispatcher {
+  friend class ESP32TransceiverIEEE802_15_4;
+  friend class ChannelHopper;
+  friend void ::esp_ieee802154_receive_done(
+      uint8_t* frame, esp_ieee802154_frame_info_t* frame_info);
+  friend void ::esp_ieee802154_transmit_done(
+      const uint8_t* frame, const uint8_t* ack,
+      esp_ieee802154_frame_info_t* ack_frame_info);
+  friend void ::esp_ieee802154_transmit_failed(const uint8_t* frame,
+                                               esp_ieee802154_tx_error_t error);
+  friend void ::esp_ieee802154_receive_sfd_done(void);
+  friend void ::esp_ieee802154_transmit_sfd_done(uint8_t* frame);
+  friend void ::esp_ieee802154_energy_detect_done(int8_t power);
+
+ public:
+  /// Maximum number of endpoints
+  static constexpr int MAX_ENDPOINTS = 4;
+
+  /// Provides the dispatcher of the radio
+  static RadioDispatcher& instance();
+
+  /// Number of registered endpoints
+  int size() const { return count; }
+
+  /// Provides the registered endpoint at the index
+  ESP32TransceiverIEEE802_15_4* get(int idx) const {
+    return idx >= 0 && idx < count ? endpoints[idx] : nullptr;
+  }
+
+  /// Returns true if the endpoints filter the received frames in software
+  bool isSoftwareFilterActive() const { return software_filter; }
+
+  /// Defines the callback for the energy detection results
+  void setEnergyDetectCallback(energy_detect_callback_t callback,
+                               void* user_data) {
+    energy_detect_callback = callback;
+    energy_detect_user_data = user_data;
+  }
+
+ protected:
+  ESP32TransceiverIEEE802_15_4* endpoints[MAX_ENDPOINTS] = {};
+  int count = 0;
+  bool software_filter = false;
+  // endpoint that owns the frame on air
+  ESP32TransceiverIEEE802_15_4* tx_owner = nullptr;
+  // the owner was removed while its frame was on air: ignore the completion
+  bool tx_owner_removed = false;
+  // protects the TX queues of all endpoints and tx_owner
+  portMUX_TYPE tx_lock = portMUX_INITIALIZER_UNLOCKED;
+  energy_detect_callback_t energy_detect_callback = nullptr;
+  void* energy_detect_user_data = nullptr;
+  // TX power of the frames without power control and current radio power
+  int8_t base_tx_power = INT8_MIN;
+  int8_t radio_tx_power = INT8_MIN;
+
+  bool add(ESP32TransceiverIEEE802_15_4* endpoint);
+  void remove(ESP32TransceiverIEEE802_15_4* endpoint);
+  bool updateFilter();
+  void updateChannel(channel_t channel);
+  int filteredCount() const;
+  ESP32TransceiverIEEE802_15_4* activeTxOwner();
+  ESP32TransceiverIEEE802_15_4* nextTxOwner(
+      ESP32TransceiverIEEE802_15_4* previous);
+  void startTx();
+  esp_err_t transmit(ESP32TransceiverIEEE802_15_4* endpoint);
+  void completeTx(esp_ieee802154_tx_error_t error);
+  void onRxDone(uint8_t* frame, esp_ieee802154_frame_info_t* frame_info);
+  void onTransmitDone(const uint8_t* frame, const uint8_t* ack,
+                      esp_ieee802154_frame_info_t* ack_frame_info);
+  void onTransmitFailed(const uint8_t* frame, esp_ieee802154_tx_error_t error);
+  void onStartFrameDelimiterReceived();
+  void onStartFrameDelimiterTransmitDone(uint8_t* frame);
+  void onEnergyDetectDone(int8_t power);
+};
+
+}  // namespace ieee802154
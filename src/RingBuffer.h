@@ -1,5 +1,10 @@
 #pragma once
 
+#include <string.h>
+
+#include <atomic>
+#include <vector>
+
 namespace ieee802154 {
 
 /**
@@ -12,59 +17,94 @@ namespace ieee802154 {
  * - Data is written at the tail and read from the head.
  * - Buffer automatically wraps around when full.
  * - Provides methods for available space, bulk read/write, and peeking.
+ * - Bulk operations use at most two memcpy calls.
+ * - The contiguous readable and writable areas can be accessed directly with
+ *   getReadSpan() / consume() and getWriteSpan() / commit().
+ *
+ * The read and write positions run from 0 to 2 * capacity, so that a full and
+ * an empty buffer can be distinguished and no division is needed to wrap them.
+ *
+ * If ThreadSafe is true, the positions are published with acquire / release
+ * semantics: one task may write and another task may read concurrently
+ * without any locking (single producer / single consumer). resize() and
+ * clear() must not be called while the buffer is in use.
+ *
+ * The data is stored in a std::vector, unless external storage is provided
+ * with setStorage(): then resize() never allocates (see StaticRingBuffer).
  *
  * @copyright GPLv3
  */
-class RingBuffer {
+template <bool ThreadSafe>
+class BasicRingBuffer {
 public:
-  RingBuffer(int size = 128) {
+  BasicRingBuffer(int size = 128) {
     resize(size);
   }
 
-  void resize(size_t new_size) {
-    buffer.resize(new_size);
+  /// Changes the capacity: with external storage it is limited to its size
+  bool resize(size_t new_size) {
+    if (p_storage != nullptr) {
+      if (new_size > storage_size) return false;
+    } else {
+      buffer.resize(new_size);
+      p_buffer = buffer.data();
+    }
     capacity = new_size;
     clear();
+    return true;
+  }
+
+  /// Uses the provided memory instead of a std::vector: releases the vector
+  void setStorage(uint8_t* data, size_t size) {
+    std::vector<uint8_t>().swap(buffer);
+    p_storage = data;
+    storage_size = size;
+    p_buffer = data;
+    capacity = size;
+    clear();
   }
 
   bool write(uint8_t byte) {
     if (isFull()) return false;
-    buffer[tail] = byte;
-    tail = (tail + 1) % capacity;
-    ++count;
+    size_t t = tail.load(std::memory_order_relaxed);
+    p_buffer[index(t)] = byte;
+    tail.store(advance(t, 1), release);
     return true;
   }
 
   int writeArray(const uint8_t* data, size_t len) {
-    int written = 0;
-    for (size_t i = 0; i < len; ++i) {
-      if (write(data[i])) {
-        ++written;
-      } else {
-        break;
-      }
+    size_t n = len < (size_t)availableForWrite() ? len : availableForWrite();
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t pos = index(t);
+    size_t first = n < capacity - pos ? n : capacity - pos;
+    if (n == 1) {
+      p_buffer[pos] = *data;  // avoid the memcpy call overhead
+    } else {
+      memcpy(p_buffer + pos, data, first);
+      memcpy(p_buffer, data + first, n - first);
     }
-    return written;
+    tail.store(advance(t, n), release);
+    return n;
   }
 
-
   int available() const {
-    return count;
+    size_t h = head.load(acquire);
+    size_t t = tail.load(acquire);
+    return t >= h ? t - h : t + 2 * capacity - h;
   }
 
   void clear() {
-    head = 0;
-    tail = 0;
-    count = 0;
+    head.store(0);
+    tail.store(0);
   }
 
   bool isFull() const {
-    return count == capacity;
+    return available() == (int)capacity;
   }
 
   bool isEmpty() const {
-    return count == 0;
-  } 
+    return head.load(acquire) == tail.load(acquire);
+  }
 
   size_t size() const {
     return capacity;
@@ -72,9 +112,9 @@ public:
 
   int read() {
     if (available() > 0) {
-      uint8_t byte = buffer[head];
-      head = (head + 1) % capacity;
-      --count;
+      size_t h = head.load(std::memory_order_relaxed);
+      uint8_t byte = p_buffer[index(h)];
+      head.store(advance(h, 1), release);
       return byte;
     }
     return 0;  // No data available
@@ -82,17 +122,24 @@ public:
 
   // Read up to len bytes into dest, returns number of bytes read
   int readArray(uint8_t* dest, size_t len) {
-    int n = 0;
-    while (n < (int)len && available() > 0) {
-      dest[n++] = read();
+    size_t n = len < (size_t)available() ? len : available();
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t pos = index(h);
+    size_t first = n < capacity - pos ? n : capacity - pos;
+    if (n == 1) {
+      *dest = p_buffer[pos];  // avoid the memcpy call overhead
+    } else {
+      memcpy(dest, p_buffer + pos, first);
+      memcpy(dest + first, p_buffer, n - first);
     }
+    head.store(advance(h, n), release);
     return n;
   }
 
   // Peek at the next byte without removing it
   bool peek(uint8_t& out) const {
     if (available() > 0) {
-      out = buffer[head];
+      out = p_buffer[index(head.load(std::memory_order_relaxed))];
       return true;
     }
     return false;
@@ -100,15 +147,79 @@ public:
 
   // Returns available space for writing
   int availableForWrite() const {
-    return capacity - count;
+    return capacity - available();
+  }
+
+  // Provides the contiguous readable area: returns its length
+  size_t getReadSpan(const uint8_t*& data) const {
+    size_t pos = index(head.load(std::memory_order_relaxed));
+    size_t len = available();
+    data = p_buffer + pos;
+    return len < capacity - pos ? len : capacity - pos;
+  }
+
+  // Removes len bytes that were processed via getReadSpan()
+  void consume(size_t len) {
+    if (len > (size_t)available()) len = available();
+    head.store(advance(head.load(std::memory_order_relaxed), len), release);
+  }
+
+  // Provides the contiguous writable area: returns its length
+  size_t getWriteSpan(uint8_t*& data) {
+    size_t pos = index(tail.load(std::memory_order_relaxed));
+    size_t len = availableForWrite();
+    data = p_buffer + pos;
+    return len < capacity - pos ? len : capacity - pos;
+  }
+
+  // Adds len bytes that were written via getWriteSpan()
+  void commit(size_t len) {
+    if (len > (size_t)availableForWrite()) len = availableForWrite();
+    tail.store(advance(tail.load(std::memory_order_relaxed), len), release);
   }
 
 private:
+  static constexpr std::memory_order acquire =
+      ThreadSafe ? std::memory_order_acquire : std::memory_order_relaxed;
+  static constexpr std::memory_order release =
+      ThreadSafe ? std::memory_order_release : std::memory_order_relaxed;
   std::vector<uint8_t> buffer;
+  uint8_t* p_buffer = nullptr;
+  uint8_t* p_storage = nullptr;  // external storage
+  size_t storage_size = 0;
   size_t capacity = 0;
-  size_t head = 0;
-  size_t tail = 0;
-  int count = 0;
+  std::atomic<size_t> head{0};  // read position: 0 .. 2 * capacity - 1
+  std::atomic<size_t> tail{0};  // write position: 0 .. 2 * capacity - 1
+
+  size_t index(size_t pos) const {
+    return pos >= capacity ? pos - capacity : pos;
+  }
+
+  size_t advance(size_t pos, size_t n) const {
+    pos += n;
+    return pos >= 2 * capacity ? pos - 2 * capacity : pos;
+  }
+};
+
+/// Ring buffer for use by a single task
+using RingBuffer = BasicRingBuffer<false>;
+
+/// Lock-free ring buffer for one writing and one reading task
+using SPSCRingBuffer = BasicRingBuffer<true>;
+
+/**
+ * @brief Ring buffer with a fixed capacity that is part of the object, so
+ * that no heap is used.
+ */
+template <size_t N, bool ThreadSafe = false>
+class StaticRingBuffer : public BasicRingBuffer<ThreadSafe> {
+ public:
+  StaticRingBuffer() : BasicRingBuffer<ThreadSafe>(0) {
+    this->setStorage(data, N);
+  }
+
+ protected:
+  uint8_t data[N];
 };
 
-}  // namespace ieee802154
\ No newline at end of file
+}  // namespace ieee802154
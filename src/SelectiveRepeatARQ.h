@@ -0,0 +1,356 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace ieee802154 {
+
+/**
+ * @brief Sliding window selective repeat ARQ (Automatic Repeat reQuest).
+ *
+ * Up to window size frames can be outstanding before an acknowledgment is
+ * needed. The receiver reports the next expected sequence number (cumulative
+ * acknowledgment) and a bitmap of the frames it has already received after it
+ * (selective acknowledgment), so only the missing frames are retransmitted.
+ * Out of order frames are buffered by the receiver and delivered in order.
+ *
+ * The class is independent of the radio: the frames are sent via the output
+ * callback and received frames must be passed to receive(). The time is
+ * provided by the caller in milliseconds.
+ *
+ * The frame buffers are allocated in begin() unless memory has been provided
+ * with setStorage().
+ *
+ * Frame formats:
+ * - Data: [0xA1][seq][data...]
+ * - Ack: [0xA2][next expected seq][32 bit bitmap, little endian]: bit i is
+ * set if seq = next expected + 1 + i was received.
+ */
+class SelectiveRepeatARQ {
+ public:
+  /// Size of the ARQ header in front of the data
+  static constexpr int HEADER_SIZE = 2;
+  /// Maximum window size (limited by the size of the ack bitmap)
+  static constexpr int MAX_WINDOW_SIZE = 32;
+
+  /// Callback to send a frame: returns false if the frame could not be sent
+  typedef bool (*output_callback_t)(const uint8_t* data, size_t len,
+                                    void* ref);
+  /// Callback to deliver received data: returns false if there is no space
+  typedef bool (*deliver_callback_t)(const uint8_t* data, size_t len,
+                                     void* ref);
+
+  /// Defines the callback that is used to send the frames
+  void setOutput(output_callback_t callback, void* ref) {
+    output_callback = callback;
+    output_ref = ref;
+  }
+
+  /// Defines the callback that receives the data in order
+  void setDeliver(deliver_callback_t callback, void* ref) {
+    deliver_callback = callback;
+    deliver_ref = ref;
+  }
+
+  /// Uses the provided memory for the frame buffers instead of the heap
+  void setStorage(uint8_t* data, size_t size) {
+    std::vector<uint8_t>().swap(data_buffer);
+    p_storage = data;
+    storage_size = size;
+  }
+
+  /// Number of bytes needed for the frame buffers
+  static constexpr size_t storageSize(int windowSize, int maxDataSize) {
+    return 2 * windowSize * (maxDataSize + HEADER_SIZE);
+  }
+
+  /**
+   * @brief Initialize the ARQ state
+   * @param windowSize Number of outstanding frames: rounded down to a power of
+   * 2 and limited to MAX_WINDOW_SIZE.
+   * @param maxDataSize Maximum number of data bytes per frame.
+   * @param retransmitTimeoutMs Time after which unacknowledged frames are sent
+   * again.
+   * @return false if the parameters are invalid or the provided storage is
+   * too small.
+   */
+  bool begin(int windowSize, int maxDataSize, uint32_t retransmitTimeoutMs) {
+    window = 0;
+    if (windowSize < 1 || maxDataSize < 1) return false;
+    int size = 1;
+    while (size * 2 <= windowSize && size * 2 <= MAX_WINDOW_SIZE) {
+      size *= 2;
+    }
+    size_t needed = storageSize(size, maxDataSize);
+    uint8_t* data = p_storage;
+    if (data == nullptr) {
+      data_buffer.assign(needed, 0);
+      data = data_buffer.data();
+    } else if (storage_size < needed) {
+      return false;
+    }
+    window = size;
+    frame_size = maxDataSize + HEADER_SIZE;
+    retransmit_timeout_ms = retransmitTimeoutMs;
+    for (int j = 0; j < MAX_WINDOW_SIZE; j++) {
+      tx_entries[j] = entry_t{};
+      rx_entries[j] = entry_t{};
+    }
+    tx_data = data;
+    rx_data = data + window * frame_size;
+    tx_base = tx_next = 0;
+    rx_base = 0;
+    ack_pending = false;
+    in_order_count = 0;
+    retransmit_count = 0;
+    duplicate_count = 0;
+    return true;
+  }
+
+  /// Releases the buffers
+  void end() {
+    window = 0;
+    tx_data = rx_data = nullptr;
+    std::vector<uint8_t>().swap(data_buffer);
+  }
+
+  /// Effective window size
+  int windowSize() const { return window; }
+
+  /// Returns true if a new frame can be sent
+  bool canWrite() const {
+    return window > 0 && outstanding() < window;
+  }
+
+  /// Returns true if all sent frames have been acknowledged
+  bool isIdle() const { return outstanding() == 0; }
+
+  /// Number of frames that have been sent again
+  uint32_t retransmitCount() const { return retransmit_count; }
+
+  /// Number of received frames that had already been received
+  uint32_t duplicateCount() const { return duplicate_count; }
+
+  /// Sends the data as new frame: returns false if the window is full
+  bool write(const uint8_t* data, size_t len, uint32_t now) {
+    if (!canWrite() || len > frame_size - HEADER_SIZE) return false;
+    uint8_t seq = tx_next++;
+    entry_t& entry = tx_entries[seq % window];
+    uint8_t* frame = txFrame(seq);
+    frame[0] = TYPE_DATA;
+    frame[1] = seq;
+    memcpy(frame + HEADER_SIZE, data, len);
+    entry.len = len + HEADER_SIZE;
+    entry.used = true;
+    entry.acked = false;
+    transmit(seq, now);
+    return true;
+  }
+
+  /**
+   * @brief Processes a received frame
+   * @return false if the frame is not an ARQ frame
+   */
+  bool receive(const uint8_t* frame, size_t len, uint32_t now) {
+    if (len < HEADER_SIZE || window == 0) return false;
+    switch (frame[0]) {
+      case TYPE_DATA:
+        receiveData(frame[1], frame + HEADER_SIZE, len - HEADER_SIZE, now);
+        return true;
+      case TYPE_ACK:
+        if (len < ACK_SIZE) return false;
+        receiveAck(frame[1], frame[2] | (frame[3] << 8) | (frame[4] << 16) |
+                                 ((uint32_t)frame[5] << 24),
+                   now);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// Retransmits timed out frames, sends delayed acks and retries delivery
+  void update(uint32_t now) {
+    if (window == 0) return;
+    for (uint8_t j = 0; j < outstanding(); j++) {
+      uint8_t seq = tx_base + j;
+      entry_t& entry = tx_entries[seq % window];
+      if (!entry.acked && now - entry.sent_ms >= retransmit_timeout_ms) {
+        retransmit_count++;
+        transmit(seq, now);
+      }
+    }
+    if (deliver()) requestAck(now);
+    if (ack_pending && now - ack_pending_ms >= ACK_DELAY_MS) {
+      sendAck();
+    }
+  }
+
+ protected:
+  enum : uint8_t { TYPE_DATA = 0xA1, TYPE_ACK = 0xA2 };
+  static constexpr size_t ACK_SIZE = 6;
+  static constexpr uint32_t ACK_DELAY_MS = 5;
+  struct entry_t {
+    uint16_t len = 0;
+    uint32_t sent_ms = 0;
+    bool used = false;
+    bool acked = false;
+  };
+  output_callback_t output_callback = nullptr;
+  void* output_ref = nullptr;
+  deliver_callback_t deliver_callback = nullptr;
+  void* deliver_ref = nullptr;
+  int window = 0;
+  size_t frame_size = 0;
+  uint32_t retransmit_timeout_ms = 0;
+  entry_t tx_entries[MAX_WINDOW_SIZE];
+  entry_t rx_entries[MAX_WINDOW_SIZE];
+  std::vector<uint8_t> data_buffer;  // used w/o external storage
+  uint8_t* p_storage = nullptr;      // external storage
+  size_t storage_size = 0;
+  uint8_t* tx_data = nullptr;
+  uint8_t* rx_data = nullptr;
+  uint8_t tx_base = 0;  // oldest unacknowledged sequence number
+  uint8_t tx_next = 0;  // sequence number of the next new frame
+  uint8_t rx_base = 0;  // next sequence number to deliver
+  bool ack_pending = false;
+  uint32_t ack_pending_ms = 0;
+  int in_order_count = 0;
+  uint32_t retransmit_count = 0;
+  uint32_t duplicate_count = 0;
+
+  uint8_t outstanding() const { return tx_next - tx_base; }
+  uint8_t* txFrame(uint8_t seq) {
+    return &tx_data[(seq % window) * frame_size];
+  }
+  uint8_t* rxData(uint8_t seq) { return &rx_data[(seq % window) * frame_size]; }
+
+  void transmit(uint8_t seq, uint32_t now) {
+    entry_t& entry = tx_entries[seq % window];
+    entry.sent_ms = now;
+    if (output_callback) output_callback(txFrame(seq), entry.len, output_ref);
+  }
+
+  void receiveAck(uint8_t next, uint32_t bitmap, uint32_t now) {
+    // cumulative acknowledgment
+    uint8_t acked = next - tx_base;
+    if (acked <= outstanding()) {
+      while (tx_base != next) {
+        tx_entries[tx_base % window] = entry_t{};
+        tx_base++;
+      }
+    }
+    // selective acknowledgment
+    for (int j = 0; j < 32 && bitmap != 0; j++) {
+      if (bitmap & (1UL << j)) {
+        uint8_t seq = next + 1 + j;
+        if ((uint8_t)(seq - tx_base) < outstanding()) {
+          tx_entries[seq % window].acked = true;
+        }
+      }
+    }
+    // slide window
+    while (outstanding() > 0 && tx_entries[tx_base % window].acked) {
+      tx_entries[tx_base % window] = entry_t{};
+      tx_base++;
+    }
+    // later frames have arrived: the oldest one is missing
+    if (bitmap != 0 && outstanding() > 0) {
+      entry_t& entry = tx_entries[tx_base % window];
+      if (now - entry.sent_ms >= retransmit_timeout_ms / 4) {
+        retransmit_count++;
+        transmit(tx_base, now);
+      }
+    }
+  }
+
+  void receiveData(uint8_t seq, const uint8_t* data, size_t len,
+                   uint32_t now) {
+    uint8_t dist = seq - rx_base;
+    if (dist >= 128) {
+      // old duplicate: our ack was lost
+      duplicate_count++;
+      sendAck();
+      return;
+    }
+    if (dist >= window || len > frame_size - HEADER_SIZE) {
+      // outside of the window: will be sent again
+      return;
+    }
+    entry_t& entry = rx_entries[seq % window];
+    if (entry.used) {
+      duplicate_count++;
+      sendAck();
+      return;
+    }
+    memcpy(rxData(seq), data, len);
+    entry.len = len;
+    entry.used = true;
+    deliver();
+
+    // acknowledge gaps immediately, in order frames delayed
+    if (dist != 0 || hasOutOfOrder()) {
+      sendAck();
+    } else if (++in_order_count >= window / 2) {
+      sendAck();
+    } else {
+      requestAck(now);
+    }
+  }
+
+  /// Sends an ack with the next update() call after the ack delay
+  void requestAck(uint32_t now) {
+    if (ack_pending) return;
+    ack_pending = true;
+    ack_pending_ms = now;
+  }
+
+  /// Delivers the received frames in order: returns true if data was delivered
+  bool deliver() {
+    bool result = false;
+    while (rx_entries[rx_base % window].used) {
+      entry_t& entry = rx_entries[rx_base % window];
+      if (deliver_callback &&
+          !deliver_callback(rxData(rx_base), entry.len, deliver_ref)) {
+        break;
+      }
+      entry = entry_t{};
+      rx_base++;
+      result = true;
+    }
+    return result;
+  }
+
+  bool hasOutOfOrder() const {
+    for (int j = 1; j < window; j++) {
+      if (rx_entries[(uint8_t)(rx_base + j) % window].used) return true;
+    }
+    return false;
+  }
+
+  void sendAck() {
+    // first frame that is missing
+    uint8_t next = rx_base;
+    while ((uint8_t)(next - rx_base) < window && rx_entries[next % window].used)
+      next++;
+    uint32_t bitmap = 0;
+    for (int j = 0; j < 32; j++) {
+      uint8_t seq = next + 1 + j;
+      if ((uint8_t)(seq - rx_base) < window && rx_entries[seq % window].used) {
+        bitmap |= 1UL << j;
+      }
+    }
+    uint8_t ack[ACK_SIZE] = {TYPE_ACK,
+                             next,
+                             (uint8_t)bitmap,
+                             (uint8_t)(bitmap >> 8),
+                             (uint8_t)(bitmap >> 16),
+                             (uint8_t)(bitmap >> 24)};
+    ack_pending = false;
+    in_order_count = 0;
+    if (output_callback) output_callback(ack, ACK_SIZE, output_ref);
+  }
+};
+
+}  // namespace ieee802154
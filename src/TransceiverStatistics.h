@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "esp_ieee802154.h"
+#include "freertos/FreeRTOS.h"
+
+namespace ieee802154 {
+
+/// Number of esp_ieee802154_tx_error_t codes that are counted separately
+static constexpr int TX_ERROR_CODES = 8;
+
+/**
+ * @brief Snapshot of the transceiver statistics.
+ */
+struct transceiver_stats_t {
+  uint32_t rx_frames = 0;        // Frames queued for the receive task
+  uint32_t rx_bytes = 0;         // PSDU bytes of the queued frames
+  uint32_t rx_dropped = 0;       // Frames dropped because the queue was full
+  uint32_t rx_parse_errors = 0;  // Frames that could not be parsed
+  uint32_t tx_frames = 0;        // Frames that were sent successfully
+  uint32_t tx_bytes = 0;         // PSDU bytes of the sent frames
+  uint32_t tx_errors[TX_ERROR_CODES] = {0};  // Failures by error code
+  uint32_t retransmissions = 0;  // Frames sent again by the stream
+  uint32_t duplicates = 0;       // Duplicate frames ignored by the stream
+
+  /// Number of failed transmissions
+  uint32_t txFailed() const {
+    uint32_t result = 0;
+    for (int j = 0; j < TX_ERROR_CODES; j++) result += tx_errors[j];
+    return result;
+  }
+
+  /// Number of transmissions that failed because the channel was busy
+  uint32_t ccaFailures() const {
+    return tx_errors[ESP_IEEE802154_TX_ERR_CCA_BUSY];
+  }
+
+  /// Number of transmissions that were not acknowledged
+  uint32_t noAck() const { return tx_errors[ESP_IEEE802154_TX_ERR_NO_ACK]; }
+};
+
+/**
+ * @brief Counters of the RX and TX paths.
+ *
+ * The counters are lock-free atomics, so that they can be updated from the
+ * radio ISR and from tasks at the cost of a single atomic add. snapshot()
+ * copies them in a critical section, so the values are consistent with each
+ * other on the single core chips with an IEEE 802.15.4 radio.
+ */
+class TransceiverStatistics {
+ public:
+  /// Counts a frame that was queued for the receive task
+  void addRx(size_t len) {
+    inc(rx_frames);
+    inc(rx_bytes, len);
+  }
+
+  /// Counts a received frame that was dropped because the queue was full
+  void addRxDropped() { inc(rx_dropped); }
+
+  /// Counts a received frame that could not be parsed
+  void addRxParseError() { inc(rx_parse_errors); }
+
+  /// Counts a completed transmission
+  void addTx(esp_ieee802154_tx_error_t error, size_t len) {
+    if (error == ESP_IEEE802154_TX_ERR_NONE) {
+      inc(tx_frames);
+      inc(tx_bytes, len);
+    } else {
+      int idx = error < TX_ERROR_CODES ? error : TX_ERROR_CODES - 1;
+      inc(tx_errors[idx]);
+    }
+  }
+
+  /// Counts frames that were sent again
+  void addRetransmissions(uint32_t count = 1) { inc(retransmissions, count); }
+
+  /// Counts ignored duplicate frames
+  void addDuplicates(uint32_t count = 1) { inc(duplicates, count); }
+
+  /// Consistent copy of all counters
+  transceiver_stats_t snapshot() const {
+    transceiver_stats_t result;
+    portENTER_CRITICAL(&lock);
+    result.rx_frames = load(rx_frames);
+    result.rx_bytes = load(rx_bytes);
+    result.rx_dropped = load(rx_dropped);
+    result.rx_parse_errors = load(rx_parse_errors);
+    result.tx_frames = load(tx_frames);
+    result.tx_bytes = load(tx_bytes);
+    for (int j = 0; j < TX_ERROR_CODES; j++) {
+      result.tx_errors[j] = load(tx_errors[j]);
+    }
+    result.retransmissions = load(retransmissions);
+    result.duplicates = load(duplicates);
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  /// Sets all counters to 0
+  void reset() {
+    portENTER_CRITICAL(&lock);
+    rx_frames = rx_bytes = rx_dropped = rx_parse_errors = 0;
+    tx_frames = tx_bytes = 0;
+    for (auto& counter : tx_errors) counter = 0;
+    retransmissions = duplicates = 0;
+    portEXIT_CRITICAL(&lock);
+  }
+
+ protected:
+  typedef std::atomic<uint32_t> counter_t;
+  counter_t rx_frames{0};
+  counter_t rx_bytes{0};
+  counter_t rx_dropped{0};
+  counter_t rx_parse_errors{0};
+  counter_t tx_frames{0};
+  counter_t tx_bytes{0};
+  counter_t tx_errors[TX_ERROR_CODES] = {};
+  counter_t retransmissions{0};
+  counter_t duplicates{0};
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+  static void inc(counter_t& counter, uint32_t value = 1) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  static uint32_t load(const counter_t& counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace ieee802154
@@ -0,0 +1,517 @@
+#pragma once
+
+#include <string.h>
+
+#include <initializer_list>
+#include <vector>
+
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "esp_ieee802154.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+namespace ieee802154 {
+
+/**
+ * @brief Use of a timeslot by the node.
+ */
+enum class tsch_cell_type_t : uint8_t {
+  TX,     // Send the queued frames for the peer
+  RX,     // Receive from the peer
+  SHARED  // Send any queued frame or a beacon, otherwise receive
+};
+
+/**
+ * @brief A cell of the slotframe: a timeslot with a channel offset.
+ */
+struct tsch_cell_t {
+  uint16_t slot_offset = 0;                      // Timeslot in the slotframe
+  uint8_t channel_offset = 0;                    // Offset into the sequence
+  tsch_cell_type_t type = tsch_cell_type_t::RX;  // Use of the timeslot
+  Address peer;                                  // Destination or sender
+};
+
+/**
+ * @brief Slotframe of a node for time slotted channel hopping (TSCH).
+ *
+ * Time is divided into timeslots that are numbered by the absolute slot
+ * number (ASN) since the start of the network. The slotframe repeats every
+ * slotframe length timeslots and assigns a cell to some of the timeslots. The
+ * channel of a cell changes with each repetition:
+ *
+ *   channel = hopping sequence[(ASN + channel offset) % sequence length]
+ *
+ * so that node pairs with different channel offsets communicate in parallel
+ * on different channels and each link is spread over all channels. A node can
+ * use each timeslot for a single cell only.
+ *
+ * The schedule does not use the radio, so it can also be used to plan and
+ * verify the schedules of a network.
+ */
+class TschSchedule {
+ public:
+  /// Default TSCH hopping sequence for 16 channels (IEEE 802.15.4-2015)
+  TschSchedule(uint16_t slotframeLength = 101) {
+    setSlotframeLength(slotframeLength);
+    setHoppingSequence({channel_t::CHANNEL_16, channel_t::CHANNEL_17,
+                        channel_t::CHANNEL_23, channel_t::CHANNEL_18,
+                        channel_t::CHANNEL_26, channel_t::CHANNEL_15,
+                        channel_t::CHANNEL_25, channel_t::CHANNEL_22,
+                        channel_t::CHANNEL_19, channel_t::CHANNEL_11,
+                        channel_t::CHANNEL_12, channel_t::CHANNEL_13,
+                        channel_t::CHANNEL_24, channel_t::CHANNEL_14,
+                        channel_t::CHANNEL_20, channel_t::CHANNEL_21});
+  }
+
+  /// Defines the number of timeslots of the slotframe: removes all cells
+  void setSlotframeLength(uint16_t length) {
+    slot_cells.assign(length > 0 ? length : 1, NO_CELL);
+    cell_list.clear();
+  }
+
+  /// Number of timeslots of the slotframe
+  uint16_t getSlotframeLength() const { return slot_cells.size(); }
+
+  /// Defines the channels that are used
+  void setHoppingSequence(std::initializer_list<channel_t> channels) {
+    if (channels.size() > 0) sequence.assign(channels.begin(), channels.end());
+  }
+
+  /// Channels that are used
+  const std::vector<channel_t>& getHoppingSequence() const { return sequence; }
+
+  /// Adds a cell: returns false if its timeslot is already used
+  bool addCell(const tsch_cell_t& cell) {
+    if (cell.slot_offset >= slot_cells.size() ||
+        slot_cells[cell.slot_offset] != NO_CELL) {
+      return false;
+    }
+    slot_cells[cell.slot_offset] = cell_list.size();
+    cell_list.push_back(cell);
+    return true;
+  }
+
+  /// Adds a cell
+  bool addCell(uint16_t slotOffset, uint8_t channelOffset,
+               tsch_cell_type_t type, const Address& peer = BROADCAST_ADDRESS) {
+    tsch_cell_t cell;
+    cell.slot_offset = slotOffset;
+    cell.channel_offset = channelOffset;
+    cell.type = type;
+    cell.peer = peer;
+    return addCell(cell);
+  }
+
+  /// Removes all cells
+  void clear() { setSlotframeLength(getSlotframeLength()); }
+
+  /// All cells
+  const std::vector<tsch_cell_t>& cells() const { return cell_list; }
+
+  /// Cell that is active at the ASN or nullptr
+  const tsch_cell_t* cell(uint64_t asn) const {
+    int16_t idx = slot_cells[asn % slot_cells.size()];
+    return idx == NO_CELL ? nullptr : &cell_list[idx];
+  }
+
+  /// Channel of a cell with the channel offset at the ASN
+  channel_t channel(uint64_t asn, uint8_t channelOffset) const {
+    return sequence[(asn + channelOffset) % sequence.size()];
+  }
+
+  /// First ASN that is after the indicated one and has a cell
+  uint64_t nextActiveAsn(uint64_t asn) const {
+    if (cell_list.empty()) return UINT64_MAX;
+    for (uint64_t next = asn + 1;; next++) {
+      if (cell(next) != nullptr) return next;
+    }
+  }
+
+ protected:
+  static constexpr int16_t NO_CELL = -1;
+  std::vector<int16_t> slot_cells;  // index into cell_list per timeslot
+  std::vector<tsch_cell_t> cell_list;
+  std::vector<channel_t> sequence;
+};
+
+/**
+ * @brief Executes a TschSchedule with a transceiver: the radio changes to the
+ * channel of each cell at the start of its timeslot and the queued frames are
+ * sent in the TX and SHARED cells at the TX offset into the timeslot.
+ *
+ * Synchronization: the node without a time source starts the network (ASN 0
+ * is the time of begin()) and sends beacons with the current ASN in its idle
+ * SHARED cells. A node with a time source listens on the first channel of the
+ * hopping sequence until it receives a beacon, which defines its ASN. After
+ * that each frame from the time source corrects the clock drift: the expected
+ * start of the transmission (start of the timeslot + TX offset) is compared
+ * with the start of the received frame, which is derived from the SFD
+ * timestamp by rxFrameStartUs().
+ *
+ * The frames are delivered to the rx callback of the scheduler: beacons are
+ * consumed by the scheduler.
+ *
+ * The scheduler owns the TX side of the transceiver: it sends its frames
+ * with an explicit destination from the esp_timer task and does not change
+ * the transceiver settings. The TX queue of the transceiver has a single
+ * producer, so frames must not be sent directly with the transceiver while
+ * the scheduler is active. A scheduled frame that is queued behind a frame
+ * of another endpoint of the radio is only sent when that frame is done, so
+ * it misses its timeslot and may be sent on the channel of a later cell.
+ *
+ * Example:
+ * @code
+ * TschSchedule schedule(11);
+ * schedule.addCell(0, 0, tsch_cell_type_t::SHARED);
+ * schedule.addCell(1, 3, tsch_cell_type_t::TX, peer);
+ * schedule.addCell(2, 3, tsch_cell_type_t::RX, peer);
+ * TschScheduler scheduler(transceiver, schedule);
+ * scheduler.setTimeSource(coordinator);  // not on the coordinator
+ * transceiver.begin();
+ * scheduler.begin();
+ * scheduler.send(peer, data, len);
+ * @endcode
+ */
+class TschScheduler {
+ public:
+  /// Maximum payload of a queued frame
+  static constexpr size_t MAX_PAYLOAD = 100;
+  /// Number of frames that can be queued
+  static constexpr int TX_QUEUE_SIZE = 8;
+
+  TschScheduler(ESP32TransceiverIEEE802_15_4& transceiver,
+                TschSchedule& schedule)
+      : p_transceiver(&transceiver), p_schedule(&schedule) {}
+
+  ~TschScheduler() {
+    end();
+    if (timer) esp_timer_delete(timer);
+  }
+
+  /// Defines the duration of a timeslot (default 10 ms)
+  void setSlotDurationUs(uint32_t us) { slot_us = us; }
+
+  /// Duration of a timeslot
+  uint32_t getSlotDurationUs() const { return slot_us; }
+
+  /// Defines the time from the start of a timeslot to the transmission
+  void setTxOffsetUs(uint32_t us) { tx_offset_us = us; }
+
+  /// Defines the node that provides the time: not used by the coordinator
+  void setTimeSource(const Address& address) {
+    time_source = address;
+    has_time_source = true;
+  }
+
+  /**
+   * @brief Defines the number of slotframes between beacons: 0 for no
+   * beacons. By default only the coordinator sends a beacon in each
+   * slotframe: other nodes can forward the time to nodes that are out of the
+   * range of the coordinator.
+   */
+  void setBeaconInterval(uint16_t slotframes) {
+    beacon_interval = slotframes;
+  }
+
+  /// Defines the callback for the received frames
+  void setRxCallback(ieee802154_transceiver_rx_callback_t callback,
+                     void* user_data) {
+    rx_callback = callback;
+    rx_callback_user_data = user_data;
+  }
+
+  /// Starts the schedule: the transceiver must have been started
+  bool begin() {
+    if (p_schedule->cells().empty() || slot_us <= tx_offset_us) {
+      ESP_LOGE(TAG, "Invalid schedule or timing");
+      return false;
+    }
+    if (timer == nullptr) {
+      esp_timer_create_args_t args = {};
+      args.callback = onTimer;
+      args.arg = this;
+      args.dispatch_method = ESP_TIMER_TASK;
+      args.name = "TschScheduler";
+      if (esp_timer_create(&args, &timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create the slot timer");
+        return false;
+      }
+    }
+    end();
+    tx_len = 0;
+    p_transceiver->setRxCallback(onReceive, this);
+    is_active = true;
+    if (has_time_source) {
+      // wait for a beacon
+      is_synchronized = false;
+      return p_transceiver->setChannel(p_schedule->getHoppingSequence()[0]);
+    }
+    synchronize(esp_timer_get_time(), 0);
+    return true;
+  }
+
+  /// Stops the schedule
+  void end() {
+    if (!is_active) return;
+    is_active = false;
+    is_synchronized = false;
+    esp_timer_stop(timer);
+  }
+
+  /**
+   * @brief Queues a frame that is sent in the next TX cell of the peer or in
+   * the next SHARED cell.
+   * @return false if the queue is full or the data is too long.
+   */
+  bool send(const Address& peer, const uint8_t* data, size_t len) {
+    if (len > MAX_PAYLOAD) return false;
+    bool result = false;
+    portENTER_CRITICAL(&lock);
+    if (queue_count < TX_QUEUE_SIZE) {
+      tx_entry_t& entry = queue[(queue_head + queue_count) % TX_QUEUE_SIZE];
+      entry.peer = peer;
+      entry.len = len;
+      memcpy(entry.data, data, len);
+      queue_count++;
+      result = true;
+    }
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  /// Returns true if the node knows the ASN
+  bool isSynchronized() const { return is_synchronized; }
+
+  /// Current absolute slot number
+  uint64_t getAsn() const {
+    return asnAt(esp_timer_get_time());
+  }
+
+  /// Last clock correction by a frame of the time source in microseconds
+  int32_t getLastDriftUs() const {
+    portENTER_CRITICAL(&lock);
+    int32_t result = last_drift_us;
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  /// Number of frames that were sent in a cell
+  uint32_t getTxCount() const { return tx_count; }
+
+ protected:
+  struct tx_entry_t {
+    Address peer;
+    uint8_t len = 0;
+    uint8_t data[MAX_PAYLOAD];
+  };
+  static constexpr const char* TAG = "TschScheduler";
+  static constexpr uint8_t BEACON_MAGIC[4] = {'T', 'S', 'C', 'H'};
+  static constexpr size_t BEACON_LEN = 9;  // magic and 5 bytes ASN
+  ESP32TransceiverIEEE802_15_4* p_transceiver = nullptr;
+  TschSchedule* p_schedule = nullptr;
+  esp_timer_handle_t timer = nullptr;
+  uint32_t slot_us = 10000;
+  uint32_t tx_offset_us = 2120;
+  Address time_source;
+  bool has_time_source = false;
+  int32_t beacon_interval = -1;  // -1: 1 on the coordinator, 0 otherwise
+  uint64_t next_beacon_asn = 0;  // protected by the lock
+  ieee802154_transceiver_rx_callback_t rx_callback = nullptr;
+  void* rx_callback_user_data = nullptr;
+  bool is_active = false;
+  volatile bool is_synchronized = false;
+  // the lock protects the state that is shared by the receive task and the
+  // timer task: epoch_us, slot_asn, next_beacon_asn, last_drift_us and the
+  // queue
+  uint64_t epoch_us = 0;  // esp_timer time of ASN 0
+  uint64_t slot_asn = 0;  // ASN of the next timer event
+  int32_t last_drift_us = 0;
+  uint32_t tx_count = 0;
+  uint8_t tx_sequence = 0;
+  tx_entry_t queue[TX_QUEUE_SIZE];
+  int queue_head = 0;
+  int queue_count = 0;
+  tx_entry_t tx;         // frame to send at the TX offset
+  uint8_t tx_len = 0;    // 0: no transmission pending
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+  uint64_t epoch() const {
+    portENTER_CRITICAL(&lock);
+    uint64_t result = epoch_us;
+    portEXIT_CRITICAL(&lock);
+    return result;
+  }
+
+  uint64_t asnAt(uint64_t time_us) const {
+    uint64_t start = epoch();
+    return time_us < start ? 0 : (time_us - start) / slot_us;
+  }
+
+  /// Defines the ASN and starts the slot timer
+  void synchronize(uint64_t slotStartUs, uint64_t asn) {
+    uint64_t first_asn = asn;
+    if (p_schedule->cell(asn) == nullptr) {
+      first_asn = p_schedule->nextActiveAsn(asn);
+    }
+    esp_timer_stop(timer);
+    portENTER_CRITICAL(&lock);
+    epoch_us = slotStartUs - asn * slot_us;
+    next_beacon_asn = asn;
+    slot_asn = first_asn;
+    portEXIT_CRITICAL(&lock);
+    is_synchronized = true;
+    startTimer(epoch() + first_asn * slot_us);
+  }
+
+  void startTimer(uint64_t at_us) {
+    uint64_t now = esp_timer_get_time();
+    esp_timer_start_once(timer, at_us > now ? at_us - now : 0);
+  }
+
+  static void onTimer(void* arg) { static_cast<TschScheduler*>(arg)->onSlot(); }
+
+  void onSlot() {
+    if (!is_active || !is_synchronized) return;
+    portENTER_CRITICAL(&lock);
+    uint64_t asn = slot_asn;
+    portEXIT_CRITICAL(&lock);
+    const tsch_cell_t* cell = p_schedule->cell(asn);
+
+    // second event of a timeslot: send at the TX offset
+    if (tx_len > 0) {
+      if (sendFrame()) tx_count++;
+      tx_len = 0;
+      scheduleNext(asn);
+      return;
+    }
+
+    // start of the timeslot: change to the channel of the cell
+    if (cell != nullptr) {
+      p_transceiver->setChannel(p_schedule->channel(asn, cell->channel_offset));
+      if (cell->type != tsch_cell_type_t::RX && nextFrame(*cell, asn)) {
+        startTimer(epoch() + asn * slot_us + tx_offset_us);
+        return;
+      }
+    }
+    scheduleNext(asn);
+  }
+
+  void scheduleNext(uint64_t asn) {
+    // skip the timeslots that have passed, e.g. after a correction
+    uint64_t now_asn = asnAt(esp_timer_get_time());
+    uint64_t next = p_schedule->nextActiveAsn(asn > now_asn ? asn : now_asn);
+    portENTER_CRITICAL(&lock);
+    slot_asn = next;
+    portEXIT_CRITICAL(&lock);
+    startTimer(epoch() + next * slot_us);
+  }
+
+  /**
+   * @brief Sends the frame in tx to its peer: the frame is built with the
+   * explicit destination, so that the destination address and the other
+   * settings of the transceiver are not changed.
+   */
+  bool sendFrame() {
+    Frame frame;
+    frame.fcf = p_transceiver->getFrameControlField();
+    frame.setDestinationAddress(tx.peer);
+    if (isPeer(tx.peer, BROADCAST_ADDRESS)) frame.fcf.ackRequest = 0;
+    frame.sequenceNumber = tx_sequence++;
+    frame.payload = tx.data;
+    frame.payloadLen = tx_len;
+    return p_transceiver->sendAsync(frame) != 0;
+  }
+
+  /// Provides the frame to send in the cell in tx
+  bool nextFrame(const tsch_cell_t& cell, uint64_t asn) {
+    bool shared = cell.type == tsch_cell_type_t::SHARED;
+    portENTER_CRITICAL(&lock);
+    for (int j = 0; j < queue_count; j++) {
+      tx_entry_t& entry = queue[(queue_head + j) % TX_QUEUE_SIZE];
+      if (shared || isPeer(cell.peer, entry.peer)) {
+        tx = entry;
+        tx_len = entry.len;
+        // close the gap
+        for (int k = j; k > 0; k--) {
+          queue[(queue_head + k) % TX_QUEUE_SIZE] =
+              queue[(queue_head + k - 1) % TX_QUEUE_SIZE];
+        }
+        queue_head = (queue_head + 1) % TX_QUEUE_SIZE;
+        queue_count--;
+        break;
+      }
+    }
+    portEXIT_CRITICAL(&lock);
+    if (tx_len > 0) return true;
+
+    // idle shared cell: send a beacon
+    int32_t interval = beacon_interval;
+    if (interval < 0) interval = has_time_source ? 0 : 1;
+    if (!shared || interval <= 0) return false;
+    portENTER_CRITICAL(&lock);
+    bool beacon = asn >= next_beacon_asn;
+    if (beacon) {
+      next_beacon_asn = asn + interval * p_schedule->getSlotframeLength();
+    }
+    portEXIT_CRITICAL(&lock);
+    if (!beacon) return false;
+    tx.peer = BROADCAST_ADDRESS;
+    memcpy(tx.data, BEACON_MAGIC, sizeof(BEACON_MAGIC));
+    for (int j = 0; j < 5; j++) tx.data[4 + j] = (asn >> (8 * j)) & 0xFF;
+    tx_len = BEACON_LEN;
+    return true;
+  }
+
+  static bool isPeer(Address a, Address b) {
+    if (a.mode() != b.mode()) return false;
+    return memcmp(a.data(), b.data(), a.length()) == 0;
+  }
+
+  bool isTimeSource(const Frame& frame) {
+    if (!has_time_source) return false;
+    size_t len = time_source.length();
+    return frame.srcAddrLen == len &&
+           memcmp(frame.srcAddress, time_source.data(), len) == 0;
+  }
+
+  static void onReceive(Frame& frame, esp_ieee802154_frame_info_t& info,
+                        void* user_data) {
+    static_cast<TschScheduler*>(user_data)->receive(frame, info);
+  }
+
+  void receive(Frame& frame, esp_ieee802154_frame_info_t& info) {
+    // start of the timeslot in which the frame was sent
+    uint64_t tx_start = rxFrameStartUs(info) - tx_offset_us;
+    bool beacon = frame.payloadLen == BEACON_LEN &&
+                  memcmp(frame.payload, BEACON_MAGIC, 4) == 0;
+    if (beacon) {
+      if (isTimeSource(frame) && !is_synchronized) {
+        uint64_t asn = 0;
+        for (int j = 4; j >= 0; j--) asn = (asn << 8) | frame.payload[4 + j];
+        ESP_LOGI(TAG, "Synchronized at ASN %llu", (unsigned long long)asn);
+        synchronize(tx_start, asn);
+      } else if (isTimeSource(frame)) {
+        correctDrift(tx_start);
+      }
+      return;
+    }
+    if (is_synchronized && isTimeSource(frame)) correctDrift(tx_start);
+    if (rx_callback) rx_callback(frame, info, rx_callback_user_data);
+  }
+
+  /// Moves the epoch to the measured start of the timeslot
+  void correctDrift(uint64_t slotStartUs) {
+    uint64_t start = epoch();
+    if (slotStartUs < start) return;
+    uint64_t offset = (slotStartUs - start) % slot_us;
+    int32_t drift = offset < slot_us / 2 ? (int32_t)offset
+                                         : (int32_t)offset - (int32_t)slot_us;
+    portENTER_CRITICAL(&lock);
+    epoch_us += drift;
+    last_drift_us = drift;
+    portEXIT_CRITICAL(&lock);
+  }
+};
+
+}  // namespace ieee802154
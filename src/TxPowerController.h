@@ -0,0 +1,232 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Frame.h"
+#include "FrameView.h"
+#include "esp_ieee802154.h"
+#include "freertos/FreeRTOS.h"
+
+namespace ieee802154 {
+
+/// Power of a frame that is sent with the power set by setTxPower()
+static constexpr int8_t TX_POWER_UNCHANGED = INT8_MIN;
+
+/**
+ * @brief State of a neighbor of the TxPowerController.
+ */
+struct tx_power_neighbor_t {
+  uint64_t key = 0;         // Address bytes as little endian value
+  uint8_t key_len = 0;      // Address length: 0 for an unused entry
+  int8_t power = 0;         // TX power in dBm for the next frame
+  int16_t rssi_avg16 = 0;   // Smoothed ACK RSSI * 16
+  int8_t margin = 0;        // Additional power after failures in dB
+  uint8_t good_count = 0;   // Acknowledged frames since the last change
+  bool has_rssi = false;    // An ACK has been received
+  uint32_t last_use = 0;    // For the replacement of the oldest neighbor
+
+  /// Smoothed RSSI of the ACKs in dBm
+  int8_t rssiAvg() const { return rssi_avg16 / 16; }
+};
+
+/**
+ * @brief Closed loop TX power control per destination, so that each frame is
+ * sent with the minimal reliable power.
+ *
+ * The ACK of a frame is sent by the neighbor with the ACK TX power: the
+ * received RSSI gives the path loss, so that the power that reaches the
+ * neighbor with the target RSSI is
+ *
+ *   power = ACK TX power - ACK RSSI + target RSSI + margin
+ *
+ * The margin is increased by one step with each unacknowledged frame and
+ * with each ACK below the minimum LQI, and it is reduced by one step after a
+ * number of acknowledged frames. The power is limited to the power range.
+ * New neighbors start with the maximum power, broadcast frames are sent with
+ * the power set by ESP32TransceiverIEEE802_15_4::setTxPower().
+ *
+ * The neighbor table has a fixed size: the least recently used neighbor is
+ * replaced. The ACK results are processed in the radio ISR.
+ *
+ * Example:
+ * @code
+ * TxPowerController power;
+ * power.setTargetRssi(-85);
+ * transceiver.setTxPowerController(&power);
+ * @endcode
+ */
+class TxPowerController {
+ public:
+  /// Number of neighbors in the table
+  static constexpr int MAX_NEIGHBORS = 16;
+
+  /// Defines the range of the TX power in dBm
+  void setPowerRange(int8_t minDbm, int8_t maxDbm) {
+    min_power = minDbm;
+    max_power = maxDbm;
+  }
+
+  /// Defines the RSSI in dBm with which the frames should reach the neighbor
+  void setTargetRssi(int8_t dbm) { target_rssi = dbm; }
+
+  /// Defines the power in dBm with which the neighbors send the ACKs
+  void setAckTxPower(int8_t dbm) { ack_power = dbm; }
+
+  /// Defines the LQI of an ACK below which the margin is increased
+  void setMinLqi(uint8_t lqi) { min_lqi = lqi; }
+
+  /// Defines the step in dB by which the margin is changed
+  void setStepDb(uint8_t db) { step = db; }
+
+  /// Defines the number of acknowledged frames before the margin is reduced
+  void setDecreaseAfter(uint8_t frames) { decrease_after = frames; }
+
+  /// Power in dBm for the next frame to the address
+  int8_t getPower(Address address) {
+    uint8_t len = address.length();
+    if (len == 0) return max_power;
+    uint64_t key = address.key();
+    int8_t result = max_power;
+    portENTER_CRITICAL_SAFE(&lock);
+    tx_power_neighbor_t* neighbor = find(key, len);
+    if (neighbor) result = neighbor->power;
+    portEXIT_CRITICAL_SAFE(&lock);
+    return result;
+  }
+
+  /// Copy of the neighbor table entry with the index
+  tx_power_neighbor_t getNeighbor(int idx) const {
+    portENTER_CRITICAL_SAFE(&lock);
+    tx_power_neighbor_t result = neighbors[idx];
+    portEXIT_CRITICAL_SAFE(&lock);
+    return result;
+  }
+
+  /// Removes all neighbors
+  void clear() {
+    portENTER_CRITICAL_SAFE(&lock);
+    for (auto& neighbor : neighbors) neighbor = tx_power_neighbor_t{};
+    portEXIT_CRITICAL_SAFE(&lock);
+  }
+
+  /**
+   * @brief Power for the frame (length byte followed by the PSDU): called by
+   * the transceiver when the frame is queued.
+   */
+  int8_t powerFor(const uint8_t* frame) {
+    FrameView view(frame);
+    uint8_t len = view.destAddrLen();
+    if (!view.isValid() || len == 0 || isBroadcast(view)) {
+      return TX_POWER_UNCHANGED;
+    }
+    uint64_t key = addressKey(view.destAddress(), len);
+    portENTER_CRITICAL_SAFE(&lock);
+    tx_power_neighbor_t* neighbor = find(key, len);
+    if (neighbor == nullptr) {
+      neighbor = &oldest();
+      *neighbor = tx_power_neighbor_t{};
+      neighbor->key = key;
+      neighbor->key_len = len;
+      neighbor->power = max_power;
+    }
+    neighbor->last_use = ++use_count;
+    int8_t result = neighbor->power;
+    portEXIT_CRITICAL_SAFE(&lock);
+    return result;
+  }
+
+  /// Processes the ACK of a sent frame: called by the transceiver
+  void onAck(const uint8_t* frame, const esp_ieee802154_frame_info_t& ack) {
+    update(frame, true, ack.rssi, ack.lqi);
+  }
+
+  /// Processes a failed transmission: called by the transceiver
+  void onFailure(const uint8_t* frame, esp_ieee802154_tx_error_t error) {
+    // only a missing ACK indicates an insufficient power
+    if (error == ESP_IEEE802154_TX_ERR_NO_ACK) update(frame, false, 0, 0);
+  }
+
+ protected:
+  tx_power_neighbor_t neighbors[MAX_NEIGHBORS];
+  uint32_t use_count = 0;
+  int8_t min_power = -15;
+  int8_t max_power = 20;
+  int8_t target_rssi = -85;
+  int8_t ack_power = 20;
+  uint8_t min_lqi = 0;
+  uint8_t step = 3;
+  uint8_t decrease_after = 8;
+  int8_t max_margin = 40;
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+  void update(const uint8_t* frame, bool acked, int8_t rssi, uint8_t lqi) {
+    FrameView view(frame);
+    uint8_t len = view.destAddrLen();
+    if (!view.isValid() || len == 0) return;
+    uint64_t key = addressKey(view.destAddress(), len);
+    portENTER_CRITICAL_SAFE(&lock);
+    tx_power_neighbor_t* neighbor = find(key, len);
+    if (neighbor != nullptr) {
+      if (acked) {
+        // smooth the RSSI with a weight of 1/4
+        if (!neighbor->has_rssi) {
+          neighbor->rssi_avg16 = rssi * 16;
+          neighbor->has_rssi = true;
+        } else {
+          neighbor->rssi_avg16 += (rssi * 16 - neighbor->rssi_avg16) / 4;
+        }
+        if (lqi < min_lqi) {
+          increaseMargin(*neighbor);
+        } else if (++neighbor->good_count >= decrease_after) {
+          neighbor->good_count = 0;
+          if (neighbor->margin > 0) {
+            neighbor->margin = neighbor->margin > step ? neighbor->margin - step
+                                                       : 0;
+          }
+        }
+      } else {
+        increaseMargin(*neighbor);
+      }
+      neighbor->power = targetPower(*neighbor);
+    }
+    portEXIT_CRITICAL_SAFE(&lock);
+  }
+
+  void increaseMargin(tx_power_neighbor_t& neighbor) {
+    neighbor.good_count = 0;
+    int margin = neighbor.margin + step;
+    neighbor.margin = margin < max_margin ? margin : max_margin;
+  }
+
+  int8_t targetPower(const tx_power_neighbor_t& neighbor) const {
+    if (!neighbor.has_rssi) return max_power;
+    int power =
+        ack_power - neighbor.rssiAvg() + target_rssi + neighbor.margin;
+    if (power < min_power) return min_power;
+    if (power > max_power) return max_power;
+    return power;
+  }
+
+  tx_power_neighbor_t* find(uint64_t key, uint8_t len) {
+    for (auto& neighbor : neighbors) {
+      if (neighbor.key_len == len && neighbor.key == key) return &neighbor;
+    }
+    return nullptr;
+  }
+
+  tx_power_neighbor_t& oldest() {
+    tx_power_neighbor_t* result = &neighbors[0];
+    for (auto& neighbor : neighbors) {
+      if (neighbor.key_len == 0) return neighbor;
+      if (neighbor.last_use < result->last_use) result = &neighbor;
+    }
+    return *result;
+  }
+
+  static bool isBroadcast(const FrameView& view) {
+    return view.destAddrLen() == 2 && view.destAddress()[0] == 0xFF &&
+           view.destAddress()[1] == 0xFF;
+  }
+};
+
+}  // namespace ieee802154
@@ -0,0 +1,152 @@
+// Throughput of the selective repeat ARQ compared with the stop-and-wait mode
+// of the stream over a simulated lossy link.
+//
+// Link model: the time is counted in frame slots of one full frame air time
+// (about 4 ms). One frame can be sent per slot in each direction, the one-way
+// delay is 2 slots and data frames and acknowledgments are lost
+// independently. The throughput is reported as the share of the link
+// capacity that is used for delivered data. The stop-and-wait
+// mode waits for the MAC ACK of each frame and gives up after
+// send_retry_count (2) failed attempts, as ESP32TransceiverStreamIEEE802_15_4
+// does.
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "SelectiveRepeatARQ.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr uint32_t DELAY_SLOTS = 2;
+static constexpr size_t DATA_SIZE = 114;
+static constexpr size_t TOTAL_SIZE = 50000;
+static constexpr int SEND_RETRY_COUNT = 2;
+static constexpr uint32_t ACK_TIMEOUT_SLOTS = 2 * DELAY_SLOTS + 2;
+
+struct packet_t {
+  std::vector<uint8_t> data;
+  uint32_t arrival;
+};
+
+struct link_t {
+  std::deque<packet_t> packets;
+  std::mt19937* rng;
+  double loss;
+  uint32_t now = 0;
+};
+
+struct result_t {
+  uint32_t slots;
+  size_t delivered;
+  bool intact;
+};
+
+static bool lost(std::mt19937& rng, double loss) {
+  return std::uniform_real_distribution<>(0, 1)(rng) < loss;
+}
+
+static bool output(const uint8_t* data, size_t len, void* ref) {
+  link_t& link = *(link_t*)ref;
+  if (!lost(*link.rng, link.loss)) {
+    link.packets.push_back({std::vector<uint8_t>(data, data + len),
+                            link.now + DELAY_SLOTS});
+  }
+  return true;
+}
+
+static bool deliver(const uint8_t* data, size_t len, void* ref) {
+  std::vector<uint8_t>& received = *(std::vector<uint8_t>*)ref;
+  received.insert(received.end(), data, data + len);
+  return true;
+}
+
+static result_t runArq(const std::vector<uint8_t>& data, double loss,
+                       std::mt19937& rng) {
+  link_t forward{{}, &rng, loss}, backward{{}, &rng, loss};
+  std::vector<uint8_t> received;
+  SelectiveRepeatARQ sender, receiver;
+  // the ARQ time unit is one slot: retransmit after 30 slots
+  CHECK(sender.begin(8, DATA_SIZE, 30));
+  CHECK(receiver.begin(8, DATA_SIZE, 30));
+  sender.setOutput(output, &forward);
+  receiver.setOutput(output, &backward);
+  receiver.setDeliver(deliver, &received);
+
+  uint32_t now = 0;
+  size_t pos = 0;
+  while ((pos < data.size() || !sender.isIdle()) && now < 1000000) {
+    forward.now = backward.now = now;
+    if (pos < data.size() && sender.canWrite()) {
+      size_t len = std::min(DATA_SIZE, data.size() - pos);
+      sender.write(&data[pos], len, now);
+      pos += len;
+    }
+    while (!forward.packets.empty() && forward.packets.front().arrival <= now) {
+      packet_t& packet = forward.packets.front();
+      receiver.receive(packet.data.data(), packet.data.size(), now);
+      forward.packets.pop_front();
+    }
+    while (!backward.packets.empty() &&
+           backward.packets.front().arrival <= now) {
+      packet_t& packet = backward.packets.front();
+      sender.receive(packet.data.data(), packet.data.size(), now);
+      backward.packets.pop_front();
+    }
+    sender.update(now);
+    receiver.update(now);
+    now++;
+  }
+  return {now, received.size(), received == data};
+}
+
+static result_t runStopAndWait(const std::vector<uint8_t>& data, double loss,
+                               std::mt19937& rng) {
+  std::vector<uint8_t> received;
+  uint32_t now = 0;
+  for (size_t pos = 0; pos < data.size(); pos += DATA_SIZE) {
+    size_t len = std::min(DATA_SIZE, data.size() - pos);
+    bool delivered = false;
+    for (int attempt = 0; attempt < SEND_RETRY_COUNT; attempt++) {
+      // the receiver drops duplicates by the sequence number
+      bool data_lost = lost(rng, loss);
+      if (!data_lost && !delivered) {
+        received.insert(received.end(), &data[pos], &data[pos] + len);
+        delivered = true;
+      }
+      if (!data_lost && !lost(rng, loss)) {
+        now += 2 * DELAY_SLOTS;
+        break;
+      }
+      now += ACK_TIMEOUT_SLOTS;
+    }
+  }
+  return {now, received.size(), received == data};
+}
+
+static double utilization(const result_t& result) {
+  return result.slots ? 100.0 * result.delivered / DATA_SIZE / result.slots
+                        : 0;
+}
+
+int main() {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> data(TOTAL_SIZE);
+  for (uint8_t& byte : data) byte = rng();
+
+  printf("loss | ARQ utilization delivered | "
+         "stop-and-wait utilization delivered\n");
+  for (double loss : {0.0, 0.05, 0.1, 0.2, 0.3}) {
+    result_t arq = runArq(data, loss, rng);
+    result_t saw = runStopAndWait(data, loss, rng);
+    printf("%4.2f | %14.1f%% %8.1f%% | %24.1f%% %8.1f%%\n", loss,
+           utilization(arq), 100.0 * arq.delivered / TOTAL_SIZE,
+           utilization(saw), 100.0 * saw.delivered / TOTAL_SIZE);
+    // the ARQ delivers everything in order and keeps the pipe full
+    CHECK(arq.intact);
+    CHECK(utilization(arq) > utilization(saw));
+    if (loss >= 0.1) CHECK(!saw.intact);
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,52 @@
+// Timing helpers for the host benchmarks
+#pragma once
+#include <stdint.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_HAS_CYCLES 1
+#endif
+
+/// Measures the elapsed time and (on x86) the CPU cycles of a code section
+class Stopwatch {
+ public:
+  void start() {
+    start_time = std::chrono::steady_clock::now();
+#ifdef BENCHMARK_HAS_CYCLES
+    start_cycles = __rdtsc();
+#endif
+  }
+
+  void stop() {
+#ifdef BENCHMARK_HAS_CYCLES
+    total_cycles += __rdtsc() - start_cycles;
+#endif
+    total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_time)
+                    .count();
+  }
+
+  /// Nanoseconds per operation
+  double ns(uint64_t operations) const {
+    return operations ? (double)total_ns / operations : 0;
+  }
+
+  /// TSC cycles per operation: 0 if not supported
+  double cycles(uint64_t operations) const {
+    return operations ? (double)total_cycles / operations : 0;
+  }
+
+ protected:
+  std::chrono::steady_clock::time_point start_time;
+  uint64_t start_cycles = 0;
+  uint64_t total_cycles = 0;
+  uint64_t total_ns = 0;
+};
+
+/// Prevents that the compiler removes the computation of the value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
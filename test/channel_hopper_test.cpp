@@ -0,0 +1,91 @@
+// ChannelHopper on the virtual clock of the mocks: hop sequence, adaptive
+// dwell time, statistics and the postponed hop while a frame is on air
+#include "ChannelHopper.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static void receive() {
+  uint8_t frame[] = {12,   0x41, 0x88, 1,    0x34, 0x12, 0x09,
+                     0x00, 0x01, 0x00, 0xAA, 0,    0};
+  mock::receive(frame);
+}
+
+int main() {
+  uint8_t address[2] = {0x01, 0x00};
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           Address(address));
+  transceiver.setReceiveTask(nullptr);
+  transceiver.setPromiscuousModeActive(true);
+  transceiver.setReceiveBufferSize(4000);
+  ChannelHopper hopper(transceiver);
+  hopper.setChannels(
+      {channel_t::CHANNEL_11, channel_t::CHANNEL_15, channel_t::CHANNEL_20});
+  hopper.setDwellTimeMs(10);
+  mock::channel_switch_us = 40;
+
+  // the transceiver must be started first
+  CHECK(!hopper.begin());
+  CHECK(transceiver.begin());
+  CHECK(hopper.begin());
+  CHECK(mock::channel == 11);
+
+  mock::advance(5000);
+  receive();
+  receive();
+  mock::advance(5100);
+  CHECK(mock::channel == 15);
+  CHECK(transceiver.getChannel() == channel_t::CHANNEL_15);
+  mock::advance(10100);
+  CHECK(mock::channel == 20);
+  receive();
+  mock::advance(10100);
+  CHECK(mock::channel == 11);
+
+  // adaptive dwell: stays on the busy channel 11 for up to 30 ms, then on
+  // channel 15
+  hopper.setMaxDwellTimeMs(30);
+  for (int j = 0; j < 5; j++) {
+    receive();
+    mock::advance(10100);
+  }
+  CHECK(mock::channel == 15);
+  CHECK(hopper.getChannelStats(channel_t::CHANNEL_11).frames == 5);
+
+  // no hop while a frame is on air
+  uint8_t payload[3] = {1, 2, 3};
+  CHECK(transceiver.sendAsync(payload, sizeof(payload)) != 0);
+  int hops = hopper.getHopCount();
+  mock::advance(30000);
+  CHECK(mock::channel == 15 && (int)hopper.getHopCount() == hops);
+  mock::transmitDone();
+  mock::advance(10100);
+  CHECK(mock::channel == 20 && (int)hopper.getHopCount() == hops + 1);
+
+  hopper.end();
+  channel_hop_stats_t s11 = hopper.getChannelStats(channel_t::CHANNEL_11);
+  channel_hop_stats_t s15 = hopper.getChannelStats(channel_t::CHANNEL_15);
+  channel_hop_stats_t s20 = hopper.getChannelStats(channel_t::CHANNEL_20);
+  CHECK(s11.frames == 5 && s15.frames == 2 && s20.frames == 1);
+  CHECK(hopper.getHopTimeAvgUs() == 40 && hopper.getHopTimeMaxUs() == 40);
+  // 11: 10 + 30 ms, 15: 10 + 20 + 30 ms (postponed) + 10 ms, 20: 10 ms
+  CHECK(s11.dwell_us == 40000 && s15.dwell_us == 70000);
+  printf("11: %u frames %llu us, 15: %u frames %llu us, 20: %u frames %llu "
+         "us, %u hops\n",
+         s11.frames, (unsigned long long)s11.dwell_us, s15.frames,
+         (unsigned long long)s15.dwell_us, s20.frames,
+         (unsigned long long)s20.dwell_us, hopper.getHopCount());
+
+  // stopped: the radio stays on the channel
+  int channel = mock::channel;
+  mock::advance(100000);
+  CHECK(mock::channel == channel);
+
+  // end() of the transceiver stops the hopper
+  CHECK(hopper.begin());
+  transceiver.end();
+  CHECK(!hopper.isActive());
+
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,94 @@
+// ChannelScanner with scripted energy detection results: ranking of the
+// channels and the handling of failed measurements
+#include "ChannelScanner.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static int calls[27];
+
+// 15 is the quietest channel, 20 and 25 both average -80 dBm but 25 has
+// bursts
+static int8_t script(int channel, int n) {
+  calls[channel]++;
+  switch (channel) {
+    case 15:
+      return -95;
+    case 20:
+      return -80;
+    case 25:
+      return n % 4 == 0 ? -56 : -88;
+    case 11:
+      return -70;
+    default:
+      return -75;
+  }
+}
+
+// the results of channel 20 are lost
+static int8_t lossyScript(int channel, int n) {
+  int8_t result = script(channel, n);
+  return channel == 20 ? mock::ENERGY_LOST : result;
+}
+
+int main() {
+  uint8_t address[2] = {0x01, 0x00};
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           Address(address));
+  transceiver.setReceiveTask(nullptr);
+  ChannelScanner scanner;
+  // 25 before 20: the order of the results depends on the peak energy
+  scanner.setChannels({channel_t::CHANNEL_11, channel_t::CHANNEL_25,
+                       channel_t::CHANNEL_20, channel_t::CHANNEL_15});
+  scanner.setDwellTimeMs(1);
+  scanner.setSampleDurationUs(250);
+  CHECK(scanner.getSampleDurationUs() == 240);
+
+  // energy detection not available: one attempt per channel
+  CHECK(!scanner.scan());
+  CHECK(!mock::enabled);
+
+  mock::energy_script = script;
+  CHECK(scanner.scan(transceiver));
+  CHECK(!mock::enabled);
+  const std::vector<channel_energy_t>& results = scanner.getResults();
+  CHECK(results.size() == 4);
+  CHECK(results[0].channel == channel_t::CHANNEL_15);
+  CHECK(results[1].channel == channel_t::CHANNEL_20);
+  CHECK(results[2].channel == channel_t::CHANNEL_25);
+  CHECK(results[3].channel == channel_t::CHANNEL_11);
+  CHECK(results[0].samples == 4 && calls[15] == 4);
+  CHECK(results[1].avgDbm() == -80 && results[2].avgDbm() == -80);
+  CHECK(results[2].max_dbm == -56 && results[2].min_dbm == -88);
+  CHECK(transceiver.getChannel() == channel_t::CHANNEL_15);
+
+  // the average is rounded to the nearest value
+  channel_energy_t energy;
+  for (int8_t dbm : {-80, -80, -80, -79}) energy.add(dbm);
+  CHECK(energy.avgDbm() == -80);  // -79.75
+  energy.add(-78);
+  CHECK(energy.avgDbm() == -79);  // -79.4
+  energy = channel_energy_t();
+  for (int8_t dbm : {-80, -79}) energy.add(dbm);
+  CHECK(energy.avgDbm() == -80);  // -79.5
+
+  // a lost result skips the channel after the first timeout
+  for (int& count : calls) count = 0;
+  mock::energy_script = lossyScript;
+  int64_t start = mock::time_us;
+  CHECK(scanner.scan());
+  CHECK(calls[20] == 1 && calls[11] == 4);
+  CHECK(results.size() == 3);
+  for (const channel_energy_t& result : results) {
+    CHECK(result.channel != channel_t::CHANNEL_20);
+  }
+  CHECK(mock::time_us - start < 20000);  // a single timeout
+
+  // not while a transceiver uses the radio
+  CHECK(transceiver.begin());
+  CHECK(!scanner.scan());
+  transceiver.end();
+
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,24 @@
+// Configuration that is only accepted before begin()
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static void onBatch(Frame*, esp_ieee802154_frame_info_t*, size_t, void*) {}
+
+int main() {
+  uint8_t address[2] = {0x01, 0x00};
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           Address(address));
+
+  // the batch buffers can not be resized while the receive task uses them
+  CHECK(!transceiver.setRxBatchCallback(onBatch, nullptr, 0));
+  CHECK(transceiver.setRxBatchCallback(onBatch, nullptr, 8));
+  CHECK(transceiver.begin());
+  CHECK(!transceiver.setRxBatchCallback(onBatch, nullptr, 32));
+  transceiver.end();
+  CHECK(transceiver.setRxBatchCallback(onBatch, nullptr, 32));
+
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,186 @@
+// Fragmentation and reassembly of datagrams: the fragments of two senders
+// are delivered in order, out of order with duplicates and with losses, and
+// the tag wraps around while the delivered datagrams are kept.
+#include <algorithm>
+#include <random>
+
+#include "DatagramTransport.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+/// Provides access to the receive callback
+struct TestTransport : DatagramTransport {
+  using DatagramTransport::DatagramTransport;
+  using DatagramTransport::onReceive;
+};
+
+typedef std::vector<uint8_t> bytes_t;
+
+static std::vector<bytes_t> received;
+static std::vector<uint8_t> received_from;
+
+static void onDatagram(Address& source, const uint8_t* data, size_t len,
+                       void*) {
+  received.emplace_back(data, data + len);
+  received_from.push_back(source.data()[0]);
+}
+
+/// Completes the transmissions until the TX queues are empty
+static void pump(std::initializer_list<ESP32TransceiverIEEE802_15_4*> list) {
+  for (auto* transceiver : list) {
+    while (transceiver->getTxQueueAvailable() <
+           transceiver->getTxQueueSize()) {
+      mock::transmitDone();
+    }
+  }
+}
+
+/// Sends the datagram and returns the transmitted fragments
+static std::vector<bytes_t> send(DatagramTransport& transport,
+                                 ESP32TransceiverIEEE802_15_4& transceiver,
+                                 Address destination, const bytes_t& data) {
+  mock::tx_frames.clear();
+  CHECK(transport.send(destination, data.data(), data.size()));
+  pump({&transceiver});
+  return mock::tx_frames;
+}
+
+static void deliver(TestTransport& transport, bytes_t frame_data) {
+  Frame frame;
+  esp_ieee802154_frame_info_t info{};
+  CHECK(frame.parse(frame_data.data(), false));
+  TestTransport::onReceive(frame, info, &transport);
+}
+
+static bytes_t pattern(size_t len, int seed) {
+  bytes_t result(len);
+  for (size_t j = 0; j < len; j++) result[j] = j * 31 + seed;
+  return result;
+}
+
+int main() {
+  uint8_t a1[2] = {0x01, 0x00}, a2[2] = {0x02, 0x00}, a3[2] = {0x03, 0x00};
+  ESP32TransceiverIEEE802_15_4 t1(channel_t::CHANNEL_11, 0x1234, Address(a1));
+  ESP32TransceiverIEEE802_15_4 t2(channel_t::CHANNEL_11, 0x1234, Address(a2));
+  ESP32TransceiverIEEE802_15_4 t3(channel_t::CHANNEL_11, 0x1234, Address(a3));
+  for (auto* transceiver : {&t1, &t2, &t3}) {
+    transceiver->setReceiveTask(nullptr);
+    transceiver->setTxQueueSize(64);
+    transceiver->getFrameControlField().ackRequest = 0;
+  }
+  CHECK(t1.begin());
+  CHECK(t3.begin());
+  DatagramTransport tx1(t1), tx3(t3);
+  TestTransport rx(t2);
+  rx.setRxCallback(onDatagram, nullptr);
+  CHECK(tx1.begin() && tx3.begin() && rx.begin());
+  std::mt19937 rng(1);
+  const uint32_t timeout_us = 3000000;  // beyond the reassembly timeout
+
+  // in order: unfragmented, block boundaries and the maximum size
+  const size_t max_size = DatagramTransport::MAX_DATAGRAM_SIZE;
+  CHECK(!tx1.send(Address(a2), nullptr, 0));
+  CHECK(!tx1.send(Address(a2), nullptr, max_size + 1));
+  for (size_t len : {1, 15, 16, 100, 112, 113, 500, 1000, 4096}) {
+    received.clear();
+    bytes_t data = pattern(len, len);
+    for (auto& frame : send(tx1, t1, Address(a2), data)) deliver(rx, frame);
+    CHECK(received.size() == 1 && received[0] == data);
+  }
+  CHECK(rx.getDroppedCount() == 0 && rx.getTimeoutCount() == 0);
+
+  // two senders interleaved, shuffled and with duplicates: the late
+  // duplicates are ignored
+  for (int trial = 0; trial < 200; trial++) {
+    received.clear();
+    received_from.clear();
+    bytes_t d1 = pattern(1500 + trial, trial);
+    bytes_t d3 = pattern(700 + trial * 3, trial + 7);
+    std::vector<bytes_t> frames = send(tx1, t1, Address(a2), d1);
+    for (auto& frame : send(tx3, t3, Address(a2), d3)) {
+      frames.push_back(frame);
+    }
+    for (int j = 0; j < 5; j++) frames.push_back(frames[rng() % frames.size()]);
+    std::shuffle(frames.begin(), frames.end(), rng);
+    for (auto& frame : frames) deliver(rx, frame);
+    CHECK(received.size() == 2);
+    for (size_t j = 0; j < 2; j++) {
+      CHECK(received[j] == (received_from[j] == 0x01 ? d1 : d3));
+    }
+    mock::advance(timeout_us);
+  }
+  CHECK(rx.getTimeoutCount() == 0);
+
+  // lossy and out of order: the complete datagrams are intact, the others
+  // are discarded by the timeout
+  uint32_t received0 = rx.getReceivedCount();
+  uint32_t timeouts0 = rx.getTimeoutCount();
+  int lost = 0;
+  bool last_lost = false;
+  for (int trial = 0; trial < 1000; trial++) {
+    received.clear();
+    bytes_t data = pattern(1000, trial);
+    std::vector<bytes_t> frames = send(tx1, t1, Address(a2), data);
+    std::shuffle(frames.begin(), frames.end(), rng);
+    bool complete = true;
+    for (auto& frame : frames) {
+      if (rng() % 100 < 5) {
+        complete = false;
+        continue;
+      }
+      deliver(rx, frame);
+    }
+    if (complete) {
+      CHECK(received.size() == 1 && received[0] == data);
+    } else {
+      CHECK(received.empty());
+      lost++;
+    }
+    last_lost = !complete;
+    mock::advance(timeout_us);
+  }
+  // the timeout is detected with the next fragment
+  CHECK(lost > 0);
+  CHECK(rx.getReceivedCount() - received0 == 1000u - lost);
+  CHECK(rx.getTimeoutCount() - timeouts0 == (uint32_t)(lost - last_lost));
+
+  // the tag wraps around while a delivered datagram is kept: the unfragmented
+  // datagrams in between use no reassembly buffer, and the first fragment of
+  // the new datagram arrives last
+  received.clear();
+  bytes_t data = pattern(300, 1), small = pattern(10, 2);
+  for (int j = 0; j < 3 * 256; j++) {
+    const bytes_t& next = j % 256 == 0 ? data : small;
+    std::vector<bytes_t> frames = send(tx1, t1, Address(a2), next);
+    std::reverse(frames.begin(), frames.end());
+    for (auto& frame : frames) deliver(rx, frame);
+  }
+  CHECK(received.size() == 3 * 256);
+  CHECK(received[256] == data && received[512] == data);
+  mock::advance(timeout_us);
+
+  // bounded buffers: 6 concurrent datagrams with 4 buffers
+  received.clear();
+  uint32_t dropped0 = rx.getDroppedCount();
+  std::vector<std::vector<bytes_t>> fragments;
+  for (int k = 0; k < 6; k++) {
+    fragments.push_back(send(tx1, t1, Address(a2), pattern(300, k)));
+  }
+  for (auto& frames : fragments) deliver(rx, frames[0]);
+  for (auto& frames : fragments) {
+    for (size_t j = 1; j < frames.size(); j++) deliver(rx, frames[j]);
+  }
+  CHECK(received.size() == 4);
+  CHECK(rx.getDroppedCount() > dropped0);
+
+  // no fragment is processed after end()
+  rx.end();
+  received.clear();
+  for (auto& frame : send(tx1, t1, Address(a2), pattern(300, 9))) {
+    deliver(rx, frame);
+  }
+  CHECK(received.empty());
+  printf("ok: %d of 1000 datagrams lost\n", lost);
+  return 0;
+}
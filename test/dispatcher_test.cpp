@@ -0,0 +1,128 @@
+// Sharing of the radio by several endpoints: radio configuration, filtering
+// of the received frames and the round robin transmission
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static std::vector<std::pair<int, uint32_t>> done;
+
+static void onDone(uint32_t token, esp_ieee802154_tx_error_t, void* ref) {
+  done.push_back({(int)(intptr_t)ref, token});
+}
+
+static int count(ESP32TransceiverIEEE802_15_4& transceiver) {
+  frame_data_t packet;
+  int result = 0;
+  while (transceiver.readFrame(packet, 0)) result++;
+  return result;
+}
+
+int main() {
+  uint8_t a1[2] = {0x01, 0x00}, a2[2] = {0x02, 0x00}, a3[2] = {0x03, 0x00};
+  ESP32TransceiverIEEE802_15_4 data(channel_t::CHANNEL_11, 0x1234,
+                                    Address(a1));
+  ESP32TransceiverIEEE802_15_4 sniff(channel_t::CHANNEL_11, 0x1234,
+                                     Address(a2));
+  ESP32TransceiverIEEE802_15_4 other(channel_t::CHANNEL_12, 0x1234,
+                                     Address(a3));
+  for (auto* transceiver : {&data, &sniff, &other}) {
+    transceiver->setReceiveTask(nullptr);
+    transceiver->setReceiveBufferSize(2000);
+  }
+  RadioDispatcher& radio = RadioDispatcher::instance();
+  sniff.setPromiscuousModeActive(true);
+  sniff.setCoordinatorActive(true);
+  data.setRxWhenIdleActive(false);
+  sniff.setRxWhenIdleActive(false);
+
+  mock::hardware_filter = true;
+  CHECK(data.begin());
+  CHECK(!mock::promiscuous && !mock::coordinator && !mock::rx_when_idle);
+  CHECK(mock::short_address == 0x0001 && radio.size() == 1);
+
+  // a single endpoint uses the hardware filter
+  uint8_t f_other[] = {12,   0x41, 0x88, 1,    0x34, 0x12, 0x09,
+                       0x00, 0x01, 0x00, 0xAA, 0,    0};
+  uint8_t f_data[] = {12,   0x41, 0x88, 2,    0x34, 0x12, 0x01,
+                      0x00, 0x02, 0x00, 0xBB, 0,    0};
+  uint8_t f_bc[] = {12,   0x41, 0x88, 3,    0x34, 0x12, 0xFF,
+                    0xFF, 0x02, 0x00, 0xCC, 0,    0};
+  uint8_t f_pan[] = {12,   0x41, 0x88, 4,    0x99, 0x99, 0x01,
+                     0x00, 0x02, 0x00, 0xDD, 0,    0};
+  mock::receive(f_other);
+  mock::receive(f_data);
+  CHECK(count(data) == 1);
+
+  // a sniffer makes the radio promiscuous: it captures the foreign traffic
+  // and the data endpoint filters in software
+  CHECK(sniff.begin());
+  CHECK(mock::promiscuous);
+  // the settings of all endpoints are applied
+  CHECK(mock::coordinator && !mock::rx_when_idle);
+  CHECK(radio.isSoftwareFilterActive());
+  mock::receive(f_other);
+  mock::receive(f_data);
+  mock::receive(f_bc);
+  mock::receive(f_pan);
+  CHECK(count(data) == 2);
+  CHECK(count(sniff) == 4);
+
+  // a second data endpoint filters in software as well
+  CHECK(other.begin());
+  CHECK(other.getChannel() == channel_t::CHANNEL_11);
+  CHECK(mock::promiscuous && radio.size() == 3);
+  mock::receive(f_other);
+  CHECK(count(data) == 0 && count(other) == 0 && count(sniff) == 1);
+  other.end();
+  CHECK(mock::promiscuous && radio.size() == 2);
+
+  // an endpoint that requests acknowledgments can not share the radio
+  other.getFrameControlField().ackRequest = 1;
+  CHECK(!other.begin());
+  CHECK(radio.size() == 2);
+  other.getFrameControlField().ackRequest = 0;
+  sniff.end();
+  CHECK(!mock::promiscuous && mock::short_address == 0x0001);
+  data.getFrameControlField().ackRequest = 1;
+  CHECK(!sniff.begin());
+  CHECK(radio.size() == 1 && !mock::promiscuous);
+  data.getFrameControlField().ackRequest = 0;
+  CHECK(sniff.begin());
+
+  // TX round robin
+  data.setTxCompleteCallback(onDone, (void*)1);
+  sniff.setTxCompleteCallback(onDone, (void*)2);
+  uint8_t payload[3] = {1, 2, 3};
+  CHECK(data.sendAsync(payload, 3) && data.sendAsync(payload, 3));
+  CHECK(sniff.sendAsync(payload, 3) && sniff.sendAsync(payload, 3));
+  CHECK(mock::tx_frames.size() == 1);
+  for (int j = 0; j < 4; j++) mock::transmitDone();
+  CHECK(mock::tx_frames.size() == 4 && done.size() == 4);
+  CHECK(done[0].first == 1 && done[1].first == 2);
+  CHECK(done[2].first == 1 && done[3].first == 2);
+
+  // the frame on air stays owned by a removed endpoint: its completion is
+  // dropped and the next frame is only sent after it
+  done.clear();
+  CHECK(data.sendAsync(payload, 3) && sniff.sendAsync(payload, 3));
+  data.end();
+  CHECK(data.begin());
+  CHECK(data.sendAsync(payload, 3));
+  CHECK(mock::tx_frames.size() == 5);
+  mock::transmitDone();
+  CHECK(done.empty() && mock::tx_frames.size() == 6);
+  mock::transmitDone();
+  mock::transmitDone();
+  CHECK(done.size() == 2 && done[0].first == 2 && done[1].first == 1);
+  CHECK(data.getStatistics().tx_frames == 3);
+
+  // the radio stays enabled while it is used
+  sniff.end();
+  CHECK(mock::enabled && !mock::promiscuous && !mock::coordinator);
+  data.end();
+  CHECK(!mock::enabled);
+
+  printf("ok\n");
+  return 0;
+}
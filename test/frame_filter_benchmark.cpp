@@ -0,0 +1,131 @@
+// FrameFilter with 1000 short addresses on a synthetic traffic trace: the
+// frames accepted by the ISR filter must be the ones the application would
+// select itself. Then the RX path with the filter in the ISR is compared with
+// queueing all frames and checking the addresses after parsing.
+#include <random>
+#include <set>
+#include <vector>
+
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "benchmark.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr int TABLE_SIZE = 1000;
+static constexpr int TRACE_SIZE = 100000;
+static constexpr int PAN = 0x1234;
+
+/// Trace with 10% ACKs, 5% beacons and data frames of which 5% are
+/// addressed to an entry of the table
+static std::vector<std::vector<uint8_t>> makeTrace(
+    const std::vector<uint16_t>& table, std::mt19937& rng) {
+  std::vector<std::vector<uint8_t>> trace;
+  for (int j = 0; j < TRACE_SIZE; j++) {
+    uint8_t seq = j;
+    int kind = rng() % 100;
+    std::vector<uint8_t> frame;
+    if (kind < 10) {
+      frame = {5, 0x02, 0x00, seq, 0, 0};
+    } else if (kind < 15) {
+      frame = {0, 0x00, 0xC0, seq, 0x34, 0x12, 1, 2, 3, 4, 5, 6, 7, 8, 0, 0};
+    } else {
+      uint16_t dest = rng() % 100 < 5 ? table[rng() % table.size()]
+                                      : 2000 + rng() % 60000;
+      uint16_t src = 2000 + rng() % 60000;
+      frame = {0, 0x41, 0x88, seq, PAN & 0xFF, PAN >> 8};
+      for (uint16_t address : {dest, src}) {
+        frame.push_back(address & 0xFF);
+        frame.push_back(address >> 8);
+      }
+      int payload = 10 + rng() % 60;
+      for (int k = 0; k < payload; k++) frame.push_back(rng());
+      frame.push_back(0);
+      frame.push_back(0);
+    }
+    frame[0] = frame.size() - 1;
+    trace.push_back(frame);
+  }
+  return trace;
+}
+
+/// Receives the trace and returns the number of frames the application
+/// selects: without ISR filter the addresses are checked after parsing
+static int receiveTrace(const std::vector<std::vector<uint8_t>>& trace,
+                        FrameFilter* filter, const HashSet<uint16_t>& table,
+                        Stopwatch& watch) {
+  uint8_t address[2] = {0x01, 0x00};
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, PAN,
+                                           Address(address));
+  transceiver.setReceiveTask(nullptr);
+  transceiver.setPromiscuousModeActive(true);
+  transceiver.setFrameFilter(filter);
+  CHECK(transceiver.begin());
+
+  int selected = 0;
+  Frame frame;
+  frame_data_t packet;
+  watch.start();
+  for (const auto& data : trace) {
+    mock::receive(data.data());
+    if (!transceiver.readFrame(packet, 0)) continue;
+    if (!frame.parse(packet.frame, false)) continue;
+    if (filter != nullptr) {
+      selected++;
+    } else if (frame.fcf.frameType == 1 && frame.destAddrLen == 2 &&
+               frame.srcAddrLen == 2 && frame.destPanId == PAN) {
+      uint16_t dest = frame.destAddress[0] | frame.destAddress[1] << 8;
+      uint16_t src = frame.srcAddress[0] | frame.srcAddress[1] << 8;
+      if (table.contains(dest) || table.contains(src)) selected++;
+    }
+  }
+  watch.stop();
+  transceiver.end();
+  return selected;
+}
+
+int main() {
+  std::mt19937 rng(42);
+  std::vector<uint16_t> addresses;
+  for (int j = 0; j < TABLE_SIZE; j++) addresses.push_back(1000 + j * 7);
+  auto trace = makeTrace(addresses, rng);
+
+  FrameFilter filter;
+  filter.reserve(1, TABLE_SIZE);
+  filter.addPanId(PAN);
+  for (uint16_t address : addresses) CHECK(filter.addShortAddress(address));
+  filter.setFrameTypes({Frameype_t::DATA});
+  CHECK(filter.size() == TABLE_SIZE + 1);
+
+  // the hash set agrees with a reference set on all 16 bit keys
+  HashSet<uint16_t> table;
+  std::set<uint16_t> reference(addresses.begin(), addresses.end());
+  for (uint16_t address : addresses) table.add(address);
+  for (uint32_t key = 0; key < 0xFFFF; key++) {
+    CHECK(table.contains(key) == (reference.count(key) > 0));
+  }
+
+  // ISR filter only
+  Stopwatch isr;
+  int accepted = 0;
+  isr.start();
+  for (const auto& data : trace) accepted += filter.accepts(data.data());
+  isr.stop();
+  doNotOptimize(accepted);
+
+  Stopwatch unfiltered, filtered;
+  int expected = receiveTrace(trace, nullptr, table, unfiltered);
+  int selected = receiveTrace(trace, &filter, table, filtered);
+  CHECK(expected > 0);
+  CHECK(selected == expected && accepted == expected);
+
+  printf("%d frames, %d addresses: %d frames accepted (%.1f%%)\n", TRACE_SIZE,
+         TABLE_SIZE, accepted, 100.0 * accepted / TRACE_SIZE);
+  printf("FrameFilter::accepts()        %6.1f ns/frame\n",
+         isr.ns(TRACE_SIZE));
+  printf("RX path, check after parsing  %6.1f ns/frame\n",
+         unfiltered.ns(TRACE_SIZE));
+  printf("RX path, filter in the ISR    %6.1f ns/frame\n",
+         filtered.ns(TRACE_SIZE));
+  return 0;
+}
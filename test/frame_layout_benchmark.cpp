@@ -0,0 +1,103 @@
+// FrameLayout::build() compared with Frame::build(): both must produce the
+// same bytes for all payload lengths, then the build cost is measured.
+#include "Frame.h"
+#include "FrameLayout.h"
+#include "benchmark.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr int ITERATIONS = 5000000;
+
+template <class Layout>
+static void checkBytes(Address dest, Address src) {
+  Frame frame;
+  frame.setPAN(0x1234);
+  frame.fcf = Layout::getFrameControlField();  // setPAN() changes the FCF
+  frame.setDestinationAddress(dest);
+  frame.setSourceAddress(src);
+  Layout layout(0x1234, dest, src);
+  uint8_t payload[MAX_FRAME_LEN];
+  for (int j = 0; j < MAX_FRAME_LEN; j++) payload[j] = j * 7;
+  for (size_t len = 0; len <= Layout::MAX_PAYLOAD_SIZE; len++) {
+    uint8_t expected[MAX_FRAME_LEN] = {0};
+    uint8_t actual[MAX_FRAME_LEN] = {0};
+    frame.sequenceNumber = len;
+    frame.setPayload(payload, len);
+    size_t expected_len = frame.build(expected, false);
+    CHECK(layout.build(actual, len, payload, len) == expected_len);
+    CHECK(memcmp(expected, actual, expected_len + 1) == 0);
+  }
+}
+
+using ShortLayout = FrameLayout<addr_mode_t::SHORT, addr_mode_t::SHORT>;
+
+/// Not inlined, so that the layout build is measured as a call like the
+/// Frame::build() call
+__attribute__((noinline)) static size_t buildLayout(const ShortLayout& layout,
+                                                    uint8_t* buffer,
+                                                    uint8_t seq,
+                                                    const uint8_t* payload,
+                                                    size_t len) {
+  return layout.build(buffer, seq, payload, len);
+}
+
+int main() {
+  uint8_t short1[2] = {0x01, 0x02};
+  uint8_t short2[2] = {0x03, 0x04};
+  uint8_t extended[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  Address src(short1, addr_mode_t::SHORT);
+  Address dest(short2, addr_mode_t::SHORT);
+  Address ext(extended, addr_mode_t::EXTENDED);
+  checkBytes<ShortLayout>(dest, src);
+  checkBytes<FrameLayout<addr_mode_t::EXTENDED, addr_mode_t::SHORT, false,
+                         true>>(ext, src);
+  checkBytes<FrameLayout<addr_mode_t::SHORT, addr_mode_t::EXTENDED, true,
+                         false, true>>(dest, ext);
+  printf("FrameLayout and Frame::build() produce the same bytes\n");
+
+  Frame frame;
+  frame.fcf = ShortLayout::getFrameControlField();
+  frame.setPAN(0x1234);
+  frame.setDestinationAddress(dest);
+  frame.setSourceAddress(src);
+  ShortLayout layout(0x1234, dest, src);
+  static uint8_t payload[ShortLayout::MAX_PAYLOAD_SIZE];
+  memset(payload, 1, sizeof(payload));
+  uint8_t buffer[MAX_FRAME_LEN];
+
+  // payload of 16 to 79 bytes: the lengths are not known to the compiler
+  size_t lengths[64];
+  for (int j = 0; j < 64; j++) lengths[j] = 16 + (rand() & 63);
+  Stopwatch build, copy_build, layout_build;
+  uint32_t sum = 0;
+  build.start();
+  for (int j = 0; j < ITERATIONS; j++) {
+    frame.sequenceNumber = j;
+    frame.payload = payload;
+    frame.payloadLen = lengths[j & 63];
+    sum += frame.build(buffer, false);
+  }
+  build.stop();
+  copy_build.start();
+  for (int j = 0; j < ITERATIONS; j++) {
+    frame.sequenceNumber = j;
+    frame.setPayload(payload, lengths[j & 63]);
+    sum += frame.build(buffer, false);
+  }
+  copy_build.stop();
+  layout_build.start();
+  for (int j = 0; j < ITERATIONS; j++) {
+    sum += buildLayout(layout, buffer, j, payload, lengths[j & 63]);
+  }
+  layout_build.stop();
+  doNotOptimize(sum);
+
+  printf("Build with a 16..79 byte payload:\n");
+  printf("  Frame::build()                %.1f ns\n", build.ns(ITERATIONS));
+  printf("  Frame::setPayload() + build() %.1f ns\n",
+         copy_build.ns(ITERATIONS));
+  printf("  FrameLayout::build()          %.1f ns\n",
+         layout_build.ns(ITERATIONS));
+  return 0;
+}
@@ -0,0 +1,99 @@
+// FrameView compared with Frame::parse(): both must decode the same fields of
+// random frames, then the cost of getting the destination PAN and the payload
+// length is measured.
+#include <random>
+
+#include "Frame.h"
+#include "FrameView.h"
+#include "benchmark.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr int CORPUS_SIZE = 4096;  // power of 2
+static constexpr int ITERATIONS = 2000000;
+static uint8_t corpus[CORPUS_SIZE][MAX_FRAME_LEN];
+
+static uint8_t randomAddrMode(std::mt19937& rng) {
+  static const uint8_t modes[] = {0, 2, 2, 3};  // 1 is reserved
+  return modes[rng() % 4];
+}
+
+/// Random frame (length byte incl. FCS followed by the PSDU)
+static void randomFrame(uint8_t* out, std::mt19937& rng) {
+  Frame frame;
+  frame.fcf.frameType = rng() % 4;
+  frame.fcf.sequenceNumberSuppression = rng() % 4 == 0;
+  frame.fcf.panIdCompression = rng() % 2;
+  frame.fcf.destAddrMode = randomAddrMode(rng);
+  frame.fcf.srcAddrMode = randomAddrMode(rng);
+  frame.destAddrLen = frame.fcf.destAddrMode == 2   ? 2
+                      : frame.fcf.destAddrMode == 3 ? 8
+                                                    : 0;
+  frame.srcAddrLen = frame.fcf.srcAddrMode == 2   ? 2
+                     : frame.fcf.srcAddrMode == 3 ? 8
+                                                  : 0;
+  for (int j = 0; j < 8; j++) {
+    frame.destAddress[j] = rng();
+    frame.srcAddress[j] = rng();
+  }
+  frame.destPanId = rng();
+  frame.srcPanId = rng();
+  frame.sequenceNumber = rng();
+  uint8_t payload[100];
+  for (uint8_t& byte : payload) byte = rng();
+  frame.setPayload(payload, rng() % 90);
+  frame.build(out, false);
+  out[0]++;  // the radio adds the FCS
+}
+
+static void checkFields(const uint8_t* data) {
+  Frame frame;
+  FrameView view;
+  bool valid = frame.parse(data, false);
+  CHECK(view.parse(data) == valid);
+  if (!valid) return;
+  CHECK(frame.fcf.frameType == view.frameType());
+  CHECK(frame.sequenceNumber == view.sequenceNumber());
+  CHECK(frame.destPanId == view.destPanId());
+  CHECK(frame.srcPanId == view.srcPanId());
+  CHECK(frame.destAddrLen == view.destAddrLen());
+  CHECK(frame.srcAddrLen == view.srcAddrLen());
+  CHECK(memcmp(frame.destAddress, view.destAddress(), frame.destAddrLen) ==
+        0);
+  CHECK(memcmp(frame.srcAddress, view.srcAddress(), frame.srcAddrLen) == 0);
+  CHECK(frame.payloadLen == view.payloadLen());
+  CHECK(frame.payloadLen == 0 || frame.payload == view.payload());
+}
+
+int main() {
+  std::mt19937 rng(1);
+  for (auto& data : corpus) {
+    randomFrame(data, rng);
+    checkFields(data);
+  }
+
+  Stopwatch parse, view;
+  uint32_t sum = 0;
+  Frame frame;
+  parse.start();
+  for (int j = 0; j < ITERATIONS; j++) {
+    frame.parse(corpus[j & (CORPUS_SIZE - 1)], false);
+    sum += frame.destPanId + frame.payloadLen;
+  }
+  parse.stop();
+  view.start();
+  for (int j = 0; j < ITERATIONS; j++) {
+    FrameView frame_view(corpus[j & (CORPUS_SIZE - 1)]);
+    sum += frame_view.destPanId() + frame_view.payloadLen();
+  }
+  view.stop();
+  doNotOptimize(sum);
+
+  printf("%d random frames: the fields of FrameView and Frame match\n",
+         CORPUS_SIZE);
+  printf("destination PAN + payload length: Frame::parse %.1f ns/frame, "
+         "FrameView %.1f ns/frame\n",
+         parse.ns(ITERATIONS), view.ns(ITERATIONS));
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Latency histograms: the bucket boundaries, the percentiles of a known
+// distribution and the stages that are measured on the receive path with
+// the rx callback and with the batch callback.
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "LatencyMetrics.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+/// Provides access to the processing of the receive task
+struct TestTransceiver : ESP32TransceiverIEEE802_15_4 {
+  using ESP32TransceiverIEEE802_15_4::ESP32TransceiverIEEE802_15_4;
+  using ESP32TransceiverIEEE802_15_4::processBatch;
+  using ESP32TransceiverIEEE802_15_4::processFrame;
+};
+
+static constexpr uint32_t RADIO_TO_ISR_US = 100;
+static constexpr uint32_t QUEUE_US = 200;
+static constexpr uint32_t CALLBACK_US = 50;
+
+static int frames = 0;
+static int batches = 0;
+
+static void onReceive(Frame&, esp_ieee802154_frame_info_t&, void*) {
+  frames++;
+  mock::advance(CALLBACK_US);
+}
+
+static void onBatch(Frame*, esp_ieee802154_frame_info_t*, size_t count,
+                    void*) {
+  batches++;
+  frames += count;
+  mock::advance(CALLBACK_US);
+}
+
+/// Receives a frame with the radio timestamp RADIO_TO_ISR_US before the ISR
+static void receive() {
+  static const uint8_t frame[] = {12,   0x41, 0x88, 2,    0x34, 0x12, 0x01,
+                                  0x00, 0x02, 0x00, 0xBB, 0,    0};
+  mock::advance(1000);
+  mock::receive(frame, -50, mock::time_us - RADIO_TO_ISR_US);
+}
+
+/// Checks that each value of the histogram is the expected one
+static void checkAll(const LatencyHistogram& histogram, uint32_t count,
+                     uint32_t us) {
+  CHECK(histogram.count() == count);
+  CHECK(histogram.minUs() == us && histogram.maxUs() == us);
+  CHECK(histogram.meanUs() == us);
+}
+
+int main() {
+  // buckets: exact below 16 us, then 8 buckets per power of 2
+  LatencyHistogram histogram;
+  CHECK(LatencyHistogram::upperBound(15) == 15);
+  CHECK(LatencyHistogram::upperBound(16) == 17);
+  CHECK(LatencyHistogram::upperBound(23) == 31);
+  CHECK(LatencyHistogram::upperBound(24) == 35);
+  for (uint32_t us : {15, 16, 17, 31, 32}) histogram.add(us);
+  CHECK(histogram.bucketCount(15) == 1);
+  CHECK(histogram.bucketCount(16) == 2);  // 16 and 17
+  CHECK(histogram.bucketCount(23) == 1);
+  CHECK(histogram.bucketCount(24) == 1);
+  // values above about 16 s are counted in the last bucket
+  const int last = LatencyHistogram::BUCKETS - 1;
+  CHECK(LatencyHistogram::upperBound(last) == 16777215);
+  histogram.add(16777215);
+  histogram.add(20000000);
+  histogram.add(UINT32_MAX);
+  CHECK(histogram.bucketCount(last) == 3);
+  CHECK(histogram.maxUs() == UINT32_MAX && histogram.minUs() == 15);
+
+  // percentiles: 980 values of 100 us and 20 values of 5000 us
+  histogram.reset();
+  CHECK(histogram.count() == 0 && histogram.percentileUs(99) == 0);
+  for (int j = 0; j < 980; j++) histogram.add(100);
+  for (int j = 0; j < 20; j++) histogram.add(5000);
+  CHECK(histogram.meanUs() == (980 * 100 + 20 * 5000) / 1000);
+  CHECK(histogram.percentileUs(50) == 103);  // bucket 96..103
+  CHECK(histogram.percentileUs(98) == 103);
+  CHECK(histogram.percentileUs(99) == 5000);  // limited to the maximum
+  CHECK(histogram.percentileUs(100) == 5000);
+
+  // rx callback: the stages of each frame
+  uint8_t address[2] = {0x01, 0x00};
+  TestTransceiver transceiver(channel_t::CHANNEL_11, 0x1234, Address(address));
+  transceiver.setReceiveTask(nullptr);
+  transceiver.setRxCallback(onReceive, nullptr);
+  LatencyMetrics metrics;
+  transceiver.setLatencyMetrics(&metrics);
+  CHECK(transceiver.begin());
+  for (int j = 0; j < 10; j++) {
+    receive();
+    mock::advance(QUEUE_US);
+    Frame frame;
+    frame_data_t* packet = transceiver.receiveFrame(0);
+    CHECK(packet != nullptr);
+    transceiver.processFrame(frame, packet);
+  }
+  CHECK(frames == 10);
+  checkAll(metrics.radio_to_isr, 10, RADIO_TO_ISR_US);
+  checkAll(metrics.queue, 10, QUEUE_US);
+  checkAll(metrics.dispatch, 10, 0);
+  checkAll(metrics.callback, 10, CALLBACK_US);
+  checkAll(metrics.end_to_end, 10, RADIO_TO_ISR_US + QUEUE_US);
+
+  // batch callback: the frames of a batch share the callback times
+  transceiver.end();
+  metrics.reset();
+  frames = 0;
+  CHECK(transceiver.setRxBatchCallback(onBatch, nullptr, 4));
+  CHECK(transceiver.begin());
+  for (int j = 0; j < 3; j++) receive();
+  mock::advance(QUEUE_US);
+  transceiver.processBatch();
+  CHECK(batches == 1 && frames == 3);
+  CHECK(metrics.radio_to_isr.count() == 3);
+  CHECK(metrics.queue.minUs() == QUEUE_US);
+  CHECK(metrics.queue.maxUs() == QUEUE_US + 2000);
+  checkAll(metrics.dispatch, 3, 0);
+  checkAll(metrics.callback, 3, CALLBACK_US);
+  CHECK(metrics.end_to_end.minUs() == RADIO_TO_ISR_US + QUEUE_US);
+  CHECK(metrics.end_to_end.count() == 3);
+
+  printf("ok\n");
+  return 0;
+}
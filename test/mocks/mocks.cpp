@@ -0,0 +1,413 @@
+// Host mocks of the radio driver, the timers and FreeRTOS: the tests run in
+// a single thread and the radio callbacks are triggered by the test.
+#include "mocks.h"
+
+#include <string.h>
+
+#include <new>
+
+#include "Arduino.h"
+#include "FrameView.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs_flash.h"
+
+namespace mock {
+
+std::vector<std::vector<uint8_t>> tx_frames;
+std::vector<int8_t> tx_powers;
+bool record_tx = true;
+bool tx_fail = false;
+bool hardware_filter = false;
+bool enabled = false;
+bool promiscuous = false;
+bool coordinator = false;
+bool rx_when_idle = false;
+uint16_t panid = 0;
+uint16_t short_address = 0;
+int channel = 0;
+int8_t tx_power = 10;
+int set_tx_power_calls = 0;
+int receive_calls = 0;
+int8_t (*energy_script)(int channel, int n) = nullptr;
+int64_t time_us = 0;
+int64_t channel_switch_us = 0;
+void (*on_block)() = nullptr;
+static int energy_count = 0;
+static uint8_t last_tx_frame[128];
+
+}  // namespace mock
+
+// esp_timer
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void* arg;
+  int64_t due;
+  uint64_t period;
+  bool armed;
+};
+
+static std::vector<esp_timer*> timers;
+
+int64_t esp_timer_get_time(void) { return mock::time_us; }
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args,
+                           esp_timer_handle_t* handle) {
+  *handle = new esp_timer{args->callback, args->arg, 0, 0, false};
+  timers.push_back(*handle);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t us) {
+  timer->due = mock::time_us + us;
+  timer->period = 0;
+  timer->armed = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t us) {
+  esp_timer_start_once(timer, us);
+  timer->period = us;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer->armed) return ESP_ERR_INVALID_STATE;
+  timer->armed = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  for (size_t j = 0; j < timers.size(); j++) {
+    if (timers[j] == timer) timers.erase(timers.begin() + j);
+  }
+  delete timer;
+  return ESP_OK;
+}
+
+void mock::advance(int64_t us) {
+  int64_t end = time_us + us;
+  while (true) {
+    esp_timer* next = nullptr;
+    for (esp_timer* timer : timers) {
+      if (timer->armed && timer->due <= end &&
+          (next == nullptr || timer->due < next->due)) {
+        next = timer;
+      }
+    }
+    if (next == nullptr) break;
+    if (next->due > time_us) time_us = next->due;
+    if (next->period > 0) {
+      next->due += next->period;
+    } else {
+      next->armed = false;
+    }
+    next->callback(next->arg);
+  }
+  if (end > time_us) time_us = end;
+}
+
+// esp_ieee802154
+
+void mock::reset() {
+  tx_frames.clear();
+  tx_powers.clear();
+  record_tx = true;
+  tx_fail = false;
+  hardware_filter = false;
+  promiscuous = coordinator = rx_when_idle = false;
+  panid = short_address = 0;
+  tx_power = 10;
+  set_tx_power_calls = receive_calls = 0;
+  energy_script = nullptr;
+  energy_count = 0;
+  on_block = nullptr;
+}
+
+/// Address filter of the radio outside of the promiscuous mode: short
+/// destination addresses and the PAN ID are checked
+static bool hardwareFilterAccepts(const uint8_t* frame) {
+  ieee802154::FrameView view(frame);
+  if (!view.isValid() || view.destAddrLen() == 0) return true;
+  if (view.destPanId() != 0xFFFF && view.destPanId() != mock::panid) {
+    return false;
+  }
+  if (view.destAddrLen() != 2) return true;
+  uint16_t address = view.destAddress()[0] | (view.destAddress()[1] << 8);
+  return address == 0xFFFF || address == mock::short_address;
+}
+
+void mock::receive(const uint8_t* frame, int8_t rssi, uint64_t timestamp) {
+  if (hardware_filter && !promiscuous && !hardwareFilterAccepts(frame)) {
+    return;
+  }
+  // the driver provides a writable buffer
+  uint8_t buffer[128];
+  memcpy(buffer, frame, frame[0] + 1);
+  esp_ieee802154_frame_info_t info{};
+  info.channel = channel;
+  info.rssi = rssi;
+  info.lqi = 255;
+  info.timestamp = timestamp;
+  esp_ieee802154_receive_done(buffer, &info);
+}
+
+void mock::transmitDone(const esp_ieee802154_frame_info_t* ack_info) {
+  static uint8_t ack[] = {5, 0x02, 0x00, 0x00, 0x00, 0x00};
+  esp_ieee802154_frame_info_t info{};
+  if (ack_info) info = *ack_info;
+  esp_ieee802154_transmit_done(last_tx_frame,
+                               ack_info ? ack : nullptr, &info);
+}
+
+void mock::transmitFailed(esp_ieee802154_tx_error_t error) {
+  esp_ieee802154_transmit_failed(last_tx_frame, error);
+}
+
+esp_err_t esp_ieee802154_enable(void) {
+  mock::enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_disable(void) {
+  mock::enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_coordinator(bool enable) {
+  mock::coordinator = enable;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_promiscuous(bool enable) {
+  mock::promiscuous = enable;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_rx_when_idle(bool enable) {
+  mock::rx_when_idle = enable;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_panid(uint16_t panid) {
+  mock::panid = panid;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_channel(uint8_t channel) {
+  mock::channel = channel;
+  mock::time_us += mock::channel_switch_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_short_address(uint16_t address) {
+  mock::short_address = address;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_extended_address(const uint8_t*) {
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_ack_timeout(uint32_t) { return ESP_OK; }
+
+esp_err_t esp_ieee802154_set_txpower(int8_t power) {
+  mock::tx_power = power;
+  mock::set_tx_power_calls++;
+  return ESP_OK;
+}
+
+int8_t esp_ieee802154_get_txpower(void) { return mock::tx_power; }
+
+esp_err_t esp_ieee802154_receive(void) {
+  mock::receive_calls++;
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_receive_handle_done(const uint8_t*) { return ESP_OK; }
+
+esp_err_t esp_ieee802154_transmit(const uint8_t* frame, bool) {
+  if (mock::tx_fail) return ESP_FAIL;
+  memcpy(mock::last_tx_frame, frame, frame[0] + 1);
+  if (mock::record_tx) {
+    mock::tx_frames.emplace_back(frame, frame + frame[0] + 1);
+    mock::tx_powers.push_back(mock::tx_power);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_energy_detect(uint32_t) {
+  if (mock::energy_script == nullptr) return ESP_FAIL;
+  int8_t power = mock::energy_script(mock::channel, mock::energy_count++);
+  if (power != mock::ENERGY_LOST) esp_ieee802154_energy_detect_done(power);
+  return ESP_OK;
+}
+
+esp_ieee802154_pending_mode_t esp_ieee802154_get_pending_mode(void) {
+  return ESP_IEEE802154_AUTO_PENDING_DISABLE;
+}
+
+// nvs_flash
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+esp_err_t nvs_flash_erase(void) { return ESP_OK; }
+
+// Arduino
+
+unsigned long millis() { return mock::time_us / 1000; }
+unsigned long micros() { return mock::time_us; }
+void delay(uint32_t ms) { mock::advance(ms * 1000ll); }
+
+// FreeRTOS
+
+void vPortEnterCritical(portMUX_TYPE* mux) { mux->depth++; }
+void vPortExitCritical(portMUX_TYPE* mux) { mux->depth--; }
+
+/// Message buffer: ring buffer of messages that are prefixed by their
+/// length as in FreeRTOS
+struct StreamBufferDef_t {
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  size_t head = 0;
+  size_t used = 0;
+  bool owner = false;
+
+  void copyIn(const uint8_t* src, size_t len) {
+    size_t pos = (head + used) % size;
+    size_t first = len < size - pos ? len : size - pos;
+    memcpy(data + pos, src, first);
+    memcpy(data, src + first, len - first);
+    used += len;
+  }
+
+  void copyOut(uint8_t* dst, size_t len) {
+    size_t first = len < size - head ? len : size - head;
+    memcpy(dst, data + head, first);
+    memcpy(dst + first, data, len - first);
+    head = (head + len) % size;
+    used -= len;
+  }
+};
+
+static StreamBufferDef_t message_buffers[8];
+
+StreamBufferHandle_t xMessageBufferCreateStatic(size_t size, uint8_t* storage,
+                                                StaticMessageBuffer_t*) {
+  for (StreamBufferDef_t& buffer : message_buffers) {
+    if (buffer.data == nullptr) {
+      buffer = StreamBufferDef_t{storage, size, 0, 0, false};
+      return &buffer;
+    }
+  }
+  return nullptr;
+}
+
+StreamBufferHandle_t xMessageBufferCreate(size_t size) {
+  StreamBufferHandle_t result =
+      xMessageBufferCreateStatic(size, new uint8_t[size], nullptr);
+  if (result) result->owner = true;
+  return result;
+}
+
+void vMessageBufferDelete(StreamBufferHandle_t buffer) {
+  if (buffer->owner) delete[] buffer->data;
+  *buffer = StreamBufferDef_t{};
+}
+
+size_t xMessageBufferSendFromISR(StreamBufferHandle_t buffer, const void* data,
+                                 size_t len, BaseType_t*) {
+  uint32_t prefix = len;
+  if (buffer->used + len + sizeof(prefix) > buffer->size) return 0;
+  buffer->copyIn((const uint8_t*)&prefix, sizeof(prefix));
+  buffer->copyIn((const uint8_t*)data, len);
+  return len;
+}
+
+size_t xMessageBufferReceive(StreamBufferHandle_t buffer, void* data,
+                             size_t len, TickType_t) {
+  if (buffer->used == 0) return 0;
+  StreamBufferDef_t peek = *buffer;
+  uint32_t prefix = 0;
+  peek.copyOut((uint8_t*)&prefix, sizeof(prefix));
+  if (prefix > len) return 0;
+  *buffer = peek;
+  buffer->copyOut((uint8_t*)data, prefix);
+  return prefix;
+}
+
+/// Semaphores: the count of a binary semaphore or a mutex is at most 1. They
+/// are created in the provided buffer, so that no heap is used.
+struct QueueDefinition {
+  int count = 0;
+};
+
+static_assert(sizeof(StaticSemaphore_t) >= sizeof(QueueDefinition));
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer) {
+  return new (buffer) QueueDefinition{0};
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer) {
+  return new (buffer) QueueDefinition{1};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) {
+  if (semaphore->count == 0 && wait > 0) {
+    if (mock::on_block) mock::on_block();
+    if (semaphore->count == 0) {
+      // nothing gives the semaphore in a single threaded test
+      if (wait == portMAX_DELAY) {
+        printf("xSemaphoreTake() would block forever\n");
+        exit(1);
+      }
+      mock::advance(wait * 1000ll);
+    }
+  }
+  if (semaphore->count == 0) return pdFALSE;
+  semaphore->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  if (semaphore->count > 0) return pdFALSE;
+  semaphore->count++;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t*) {
+  return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t) {}
+
+// Tasks are not started: a handle is provided so that the library sees them
+// as running
+
+static StaticTask_t task_handle;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t,
+                                   void*, UBaseType_t, TaskHandle_t* handle,
+                                   BaseType_t) {
+  *handle = (TaskHandle_t)&task_handle;
+  return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t, const char*, uint32_t, void*,
+                               UBaseType_t, StackType_t*, StaticTask_t* task) {
+  return (TaskHandle_t)task;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t, const char*,
+                                           uint32_t, void*, UBaseType_t,
+                                           StackType_t*, StaticTask_t* task,
+                                           BaseType_t) {
+  return (TaskHandle_t)task;
+}
+
+void vTaskDelete(TaskHandle_t) {}
+void vTaskDelay(TickType_t ticks) { mock::advance(ticks * 1000ll); }
+TickType_t xTaskGetTickCount(void) { return mock::time_us / 1000; }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
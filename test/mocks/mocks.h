@@ -0,0 +1,71 @@
+// State of the host mocks of the radio driver, the timers and FreeRTOS
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "esp_ieee802154.h"
+
+namespace mock {
+
+/// Frames (length byte followed by the PSDU) passed to the radio
+extern std::vector<std::vector<uint8_t>> tx_frames;
+/// TX power of the radio for each transmitted frame
+extern std::vector<int8_t> tx_powers;
+/// The transmitted frames are not added to tx_frames when cleared, e.g. to
+/// avoid the heap allocations of the mock
+extern bool record_tx;
+/// esp_ieee802154_transmit() fails when set
+extern bool tx_fail;
+/// receive() drops the frames that the address filter of the radio rejects
+/// outside of the promiscuous mode when set
+extern bool hardware_filter;
+/// Radio configuration
+extern bool enabled;
+extern bool promiscuous;
+extern bool coordinator;
+extern bool rx_when_idle;
+extern uint16_t panid;
+extern uint16_t short_address;
+extern int channel;
+extern int8_t tx_power;
+extern int set_tx_power_calls;
+extern int receive_calls;
+/// Provides the result of the n-th energy detection: nullptr makes
+/// esp_ieee802154_energy_detect() fail and ENERGY_LOST suppresses the
+/// esp_ieee802154_energy_detect_done() callback
+extern int8_t (*energy_script)(int channel, int n);
+constexpr int8_t ENERGY_LOST = INT8_MIN;
+/// Virtual time in us: see advance()
+extern int64_t time_us;
+/// Duration of a channel change in us
+extern int64_t channel_switch_us;
+/// Called when a task would block on a semaphore: simulates the events (e.g.
+/// received frames) that happen during the wait. If the semaphore is still
+/// not given, the virtual time advances by the wait time.
+extern void (*on_block)();
+
+/// Advances the virtual time and runs the due esp_timer callbacks in order
+void advance(int64_t us);
+/// Restores the initial state of the radio
+void reset();
+/// Delivers a frame (length byte followed by the PSDU) to the library
+void receive(const uint8_t* frame, int8_t rssi = -50, uint64_t timestamp = 0);
+/// Reports the end of the last transmitted frame with an optional ACK
+void transmitDone(const esp_ieee802154_frame_info_t* ack_info = nullptr);
+/// Reports the failure of the last transmitted frame
+void transmitFailed(esp_ieee802154_tx_error_t error);
+
+}  // namespace mock
+
+/// Minimal test assertion: reports the location and fails the test
+#define CHECK(condition)                                        \
+  do {                                                          \
+    if (!(condition)) {                                         \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+             #condition);                                       \
+      exit(1);                                                  \
+    }                                                           \
+  } while (0)
@@ -0,0 +1,214 @@
+// The capture of PcapngWriter is parsed block by block: the block structure,
+// the interface and all frames with their TAP header must match what was
+// written, also when the buffer wraps and when frames are dropped. The
+// writer is used without Arduino, so only readBytes() is available.
+#include <vector>
+
+#include "PcapngWriter.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+struct captured_frame_t {
+  uint64_t timestamp;
+  float rssi;
+  uint8_t lqi;
+  uint16_t channel;
+  std::vector<uint8_t> psdu;  // without FCS
+};
+
+static uint32_t get16(const uint8_t* data) { return data[0] | data[1] << 8; }
+
+static uint32_t get32(const uint8_t* data) {
+  return get16(data) | get16(data + 2) << 16;
+}
+
+static uint64_t get64(const uint8_t* data) {
+  return get32(data) | (uint64_t)get32(data + 4) << 32;
+}
+
+/// Parses the TAP header and the frame of an Enhanced Packet Block
+static captured_frame_t parsePacket(const uint8_t* packet, size_t len) {
+  captured_frame_t result{};
+  CHECK(packet[0] == 0 && get16(packet + 2) == PcapngWriter::TAP_HEADER_SIZE);
+  size_t header_len = get16(packet + 2);
+  CHECK(len >= header_len);
+  bool has_fcs = false, has_rss = false, has_channel = false, has_lqi = false,
+       has_sof = false;
+  for (size_t pos = 4; pos < header_len;) {
+    uint16_t type = get16(packet + pos);
+    uint16_t tlv_len = get16(packet + pos + 2);
+    const uint8_t* value = packet + pos + 4;
+    switch (type) {
+      case 0:
+        CHECK(tlv_len == 1 && value[0] == 0);
+        has_fcs = true;
+        break;
+      case 1:
+        CHECK(tlv_len == 4);
+        memcpy(&result.rssi, value, 4);
+        has_rss = true;
+        break;
+      case 3:
+        CHECK(tlv_len == 3 && value[2] == 0);  // page 0
+        result.channel = get16(value);
+        has_channel = true;
+        break;
+      case 5:
+        CHECK(tlv_len == 8);
+        result.timestamp = get64(value) / 1000;
+        has_sof = true;
+        break;
+      case 10:
+        CHECK(tlv_len == 1);
+        result.lqi = value[0];
+        has_lqi = true;
+        break;
+      default:
+        CHECK(false);
+    }
+    pos += 4 + ((tlv_len + 3) & ~3);
+    CHECK(pos <= header_len);
+  }
+  CHECK(has_fcs && has_rss && has_channel && has_lqi && has_sof);
+  result.psdu.assign(packet + header_len, packet + len);
+  return result;
+}
+
+/// Parses a complete capture and returns the frames
+static std::vector<captured_frame_t> parse(const std::vector<uint8_t>& data) {
+  std::vector<captured_frame_t> result;
+  size_t pos = 0;
+  int blocks = 0;
+  bool resolution_us = false;
+  while (pos < data.size()) {
+    CHECK(data.size() - pos >= 12);
+    const uint8_t* block = data.data() + pos;
+    uint32_t type = get32(block);
+    uint32_t len = get32(block + 4);
+    CHECK(len % 4 == 0 && len >= 12 && pos + len <= data.size());
+    CHECK(get32(block + len - 4) == len);
+    const uint8_t* body = block + 8;
+    if (blocks == 0) {
+      // Section Header Block
+      CHECK(type == 0x0A0D0D0A);
+      CHECK(get32(body) == 0x1A2B3C4D);
+      CHECK(get16(body + 4) == 1 && get16(body + 6) == 0);
+      CHECK(get64(body + 8) == UINT64_MAX);
+    } else if (blocks == 1) {
+      // Interface Description Block with its options
+      CHECK(type == 1);
+      CHECK(get16(body) == PcapngWriter::LINKTYPE);
+      for (size_t opt = 8; opt < len - 12;) {
+        uint16_t code = get16(body + opt);
+        uint16_t opt_len = get16(body + opt + 2);
+        if (code == 0) break;
+        if (code == 9) resolution_us = opt_len == 1 && body[opt + 4] == 6;
+        opt += 4 + ((opt_len + 3) & ~3);
+      }
+      CHECK(resolution_us);
+    } else {
+      // Enhanced Packet Block
+      CHECK(type == 6);
+      CHECK(get32(body) == 0);  // interface
+      uint64_t timestamp = (uint64_t)get32(body + 4) << 32 | get32(body + 8);
+      uint32_t captured = get32(body + 12);
+      CHECK(get32(body + 16) == captured);
+      CHECK(len == 32 + ((captured + 3) & ~3u));
+      captured_frame_t frame = parsePacket(body + 20, captured);
+      CHECK(frame.timestamp == timestamp);
+      result.push_back(frame);
+    }
+    blocks++;
+    pos += len;
+  }
+  CHECK(blocks >= 2);
+  return result;
+}
+
+/// Frame with the length byte (incl. FCS) and a PSDU of len bytes
+static std::vector<uint8_t> makeFrame(int len, int seed) {
+  std::vector<uint8_t> frame(len + 1);
+  frame[0] = len;
+  for (int j = 1; j <= len; j++) frame[j] = seed * 31 + j;
+  return frame;
+}
+
+static esp_ieee802154_frame_info_t makeInfo(int seed) {
+  esp_ieee802154_frame_info_t info{};
+  info.rssi = -40 - seed % 50;
+  info.lqi = seed * 7;
+  info.channel = 11 + seed % 16;
+  info.timestamp = 1000000ull * seed + 123 + ((uint64_t)seed << 32);
+  return info;
+}
+
+static std::vector<uint8_t> readAll(PcapngWriter& writer, size_t chunk) {
+  std::vector<uint8_t> result;
+  uint8_t buffer[256];
+  size_t len;
+  while ((len = writer.readBytes(buffer, chunk)) > 0) {
+    result.insert(result.end(), buffer, buffer + len);
+  }
+  return result;
+}
+
+static void checkFrame(const captured_frame_t& frame, int len, int seed) {
+  esp_ieee802154_frame_info_t info = makeInfo(seed);
+  std::vector<uint8_t> expected = makeFrame(len, seed);
+  // the FCS is not captured
+  size_t psdu_len = len >= 2 ? len - 2 : 0;
+  CHECK(frame.psdu.size() == psdu_len);
+  CHECK(memcmp(frame.psdu.data(), expected.data() + 1, psdu_len) == 0);
+  CHECK(frame.timestamp == info.timestamp);
+  CHECK(frame.rssi == info.rssi);
+  CHECK(frame.lqi == info.lqi && frame.channel == info.channel);
+}
+
+int main() {
+  // all frame lengths in one capture
+  PcapngWriter writer(64 * 1024);
+  CHECK(writer.begin());
+  for (int len = 0; len < MAX_FRAME_LEN; len++) {
+    CHECK(writer.write(makeFrame(len, len).data(), makeInfo(len)));
+  }
+  std::vector<captured_frame_t> frames = parse(readAll(writer, 256));
+  CHECK(frames.size() == MAX_FRAME_LEN);
+  for (int len = 0; len < MAX_FRAME_LEN; len++) {
+    checkFrame(frames[len], len, len);
+  }
+
+  // small buffer: the blocks wrap around and full blocks are dropped
+  PcapngWriter small(PcapngWriter::MAX_BLOCK_SIZE * 2);
+  CHECK(small.begin());
+  std::vector<uint8_t> capture = readAll(small, 7);
+  int written = 0;
+  for (int j = 0; j < 200; j++) {
+    int len = 5 + (j * 37) % 120;
+    if (small.write(makeFrame(len, j).data(), makeInfo(j))) written++;
+    if (j % 3 == 2) {
+      std::vector<uint8_t> part = readAll(small, 13);
+      capture.insert(capture.end(), part.begin(), part.end());
+    }
+  }
+  std::vector<uint8_t> part = readAll(small, 13);
+  capture.insert(capture.end(), part.begin(), part.end());
+  CHECK(small.droppedCount() > 0);
+  CHECK(small.capturedCount() == (uint32_t)written);
+  CHECK(small.droppedCount() + small.capturedCount() == 200);
+  frames = parse(capture);
+  CHECK(frames.size() == (size_t)written);
+  // the captured frames are in order: find them by their timestamps
+  int seed = 0;
+  for (const captured_frame_t& frame : frames) {
+    while (makeInfo(seed).timestamp != frame.timestamp) {
+      seed++;
+      CHECK(seed < 200);
+    }
+    checkFrame(frame, 5 + (seed * 37) % 120, seed);
+  }
+
+  printf("ok: %d frames of all lengths, %d of 200 frames with wrap around\n",
+         MAX_FRAME_LEN, written);
+  return 0;
+}
@@ -0,0 +1,87 @@
+// Throughput of the ring buffer for writing and reading chunks of 1, 16 and
+// 116 bytes, compared with the former byte by byte implementation.
+#include "RingBuffer.h"
+#include "benchmark.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr size_t CAPACITY = 1024;
+static constexpr size_t TOTAL_BYTES = 16 * 1024 * 1024;
+
+/// The former implementation: bulk operations loop over write() and read()
+class ByteLoopRingBuffer {
+ public:
+  explicit ByteLoopRingBuffer(size_t size) : buffer(size), capacity(size) {}
+
+  bool write(uint8_t byte) {
+    if (count == capacity) return false;
+    buffer[tail] = byte;
+    tail = (tail + 1) % capacity;
+    ++count;
+    return true;
+  }
+
+  int writeArray(const uint8_t* data, size_t len) {
+    int written = 0;
+    for (size_t j = 0; j < len && write(data[j]); ++j) ++written;
+    return written;
+  }
+
+  int read() {
+    if (count == 0) return 0;
+    uint8_t byte = buffer[head];
+    head = (head + 1) % capacity;
+    --count;
+    return byte;
+  }
+
+  int readArray(uint8_t* dest, size_t len) {
+    int n = 0;
+    while (n < (int)len && count > 0) dest[n++] = read();
+    return n;
+  }
+
+ protected:
+  std::vector<uint8_t> buffer;
+  size_t capacity = 0;
+  size_t head = 0;
+  size_t tail = 0;
+  size_t count = 0;
+};
+
+/// Moves TOTAL_BYTES through the buffer and returns MB/s
+template <class T>
+static double run(T& buffer, size_t chunk) {
+  uint8_t in[116], out[116];
+  for (size_t j = 0; j < chunk; j++) in[j] = j;
+  Stopwatch watch;
+  uint64_t checksum = 0;
+  watch.start();
+  // keep the buffer half full, so that the chunks wrap around
+  for (size_t j = 0; j < CAPACITY / 2; j += chunk) buffer.writeArray(in, chunk);
+  for (size_t total = 0; total < TOTAL_BYTES; total += chunk) {
+    CHECK(buffer.writeArray(in, chunk) == (int)chunk);
+    CHECK(buffer.readArray(out, chunk) == (int)chunk);
+    checksum += out[chunk - 1];
+  }
+  watch.stop();
+  doNotOptimize(checksum);
+  return 1000.0 / watch.ns(TOTAL_BYTES);
+}
+
+int main() {
+  printf("MB/s written and read through a %zu byte ring buffer:\n", CAPACITY);
+  printf("chunk | byte loop | RingBuffer | SPSCRingBuffer\n");
+  for (size_t chunk : {1, 16, 116}) {
+    ByteLoopRingBuffer loop(CAPACITY);
+    RingBuffer bulk(CAPACITY);
+    SPSCRingBuffer spsc(CAPACITY);
+    double loop_mbs = run(loop, chunk);
+    double bulk_mbs = run(bulk, chunk);
+    double spsc_mbs = run(spsc, chunk);
+    printf("%5zu | %9.0f | %10.0f | %14.0f\n", chunk, loop_mbs, bulk_mbs,
+           spsc_mbs);
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Random sequences of single byte, bulk and span operations on the ring
+// buffer, checked against a std::deque.
+#include <deque>
+#include <random>
+
+#include "RingBuffer.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+template <class T>
+static void check(T& buffer, int capacity, std::mt19937& rng) {
+  std::deque<uint8_t> expected;
+  uint8_t tmp[300];
+  for (int step = 0; step < 200000; step++) {
+    switch (rng() % 6) {
+      case 0: {
+        uint8_t byte = rng();
+        bool full = expected.size() == (size_t)capacity;
+        CHECK(buffer.write(byte) == !full);
+        if (!full) expected.push_back(byte);
+        break;
+      }
+      case 1: {
+        int len = rng() % (capacity * 2 + 1);
+        for (int j = 0; j < len; j++) tmp[j] = rng();
+        int free = capacity - expected.size();
+        int written = buffer.writeArray(tmp, len);
+        CHECK(written == std::min(len, free));
+        expected.insert(expected.end(), tmp, tmp + written);
+        break;
+      }
+      case 2: {
+        int len = rng() % (capacity * 2 + 1);
+        int read = buffer.readArray(tmp, len);
+        CHECK(read == std::min<int>(len, expected.size()));
+        for (int j = 0; j < read; j++) {
+          CHECK(tmp[j] == expected.front());
+          expected.pop_front();
+        }
+        break;
+      }
+      case 3:
+        if (!expected.empty()) {
+          CHECK(buffer.read() == expected.front());
+          expected.pop_front();
+        } else {
+          CHECK(buffer.read() == 0);
+        }
+        break;
+      case 4: {
+        const uint8_t* data;
+        size_t len = buffer.getReadSpan(data);
+        CHECK(len <= expected.size());
+        size_t consumed = rng() % (len + 1);
+        for (size_t j = 0; j < consumed; j++) {
+          CHECK(data[j] == expected.front());
+          expected.pop_front();
+        }
+        buffer.consume(consumed);
+        break;
+      }
+      default: {
+        uint8_t* data;
+        size_t len = buffer.getWriteSpan(data);
+        CHECK(len <= capacity - expected.size());
+        size_t committed = rng() % (len + 1);
+        for (size_t j = 0; j < committed; j++) {
+          data[j] = rng();
+          expected.push_back(data[j]);
+        }
+        buffer.commit(committed);
+        break;
+      }
+    }
+    CHECK((size_t)buffer.available() == expected.size());
+    CHECK(buffer.availableForWrite() == capacity - (int)expected.size());
+    CHECK(buffer.isFull() == (expected.size() == (size_t)capacity));
+    CHECK(buffer.isEmpty() == expected.empty());
+  }
+}
+
+int main() {
+  std::mt19937 rng(3);
+  for (int capacity : {1, 7, 16, 100}) {
+    RingBuffer buffer(capacity);
+    check(buffer, capacity, rng);
+    SPSCRingBuffer spsc(capacity);
+    check(spsc, capacity, rng);
+  }
+  StaticRingBuffer<64> fixed;
+  check(fixed, 64, rng);
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Batch delivery of the receive task: a full batch is delivered with a single
+// callback, a partial batch after the maximum latency and a frame that cannot
+// be parsed is released.
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+/// Provides access to the processing of the receive task
+struct TestTransceiver : ESP32TransceiverIEEE802_15_4 {
+  using ESP32TransceiverIEEE802_15_4::ESP32TransceiverIEEE802_15_4;
+  using ESP32TransceiverIEEE802_15_4::processBatch;
+};
+
+static constexpr int POOL_SIZE = 8;
+static constexpr size_t BATCH_SIZE = 4;
+static constexpr uint32_t LATENCY_MS = 10;
+
+static int batches = 0;
+static std::vector<uint8_t> sequence_numbers;
+
+static void onBatch(Frame* frames, esp_ieee802154_frame_info_t*, size_t count,
+                    void*) {
+  batches++;
+  for (size_t j = 0; j < count; j++) {
+    sequence_numbers.push_back(frames[j].sequenceNumber);
+  }
+}
+
+static void receive(uint8_t seq) {
+  const uint8_t frame[] = {12,   0x41, 0x88, seq,  0x34, 0x12, 0x01,
+                           0x00, 0x02, 0x00, 0xBB, 0,    0};
+  mock::receive(frame);
+}
+
+/// A frame arrives 3 ms into the first wait of the receive task
+static int blocked = 0;
+static void onBlockReceive() {
+  if (blocked++ == 0) {
+    mock::advance(3000);
+    receive(21);
+  }
+}
+
+int main() {
+  uint8_t address[2] = {0x01, 0x00};
+  TestTransceiver transceiver(channel_t::CHANNEL_11, 0x1234, Address(address));
+  transceiver.setReceiveTask(nullptr);
+  transceiver.setFramePoolSize(POOL_SIZE);
+  CHECK(transceiver.setRxBatchCallback(onBatch, nullptr, BATCH_SIZE,
+                                       LATENCY_MS));
+  CHECK(transceiver.begin());
+
+  // full batch: delivered with one callback without waiting, the remaining
+  // frame is left for the next batch
+  for (uint8_t seq = 1; seq <= 5; seq++) receive(seq);
+  int64_t start = mock::time_us;
+  transceiver.processBatch();
+  CHECK(batches == 1);
+  CHECK(sequence_numbers == std::vector<uint8_t>({1, 2, 3, 4}));
+  CHECK(mock::time_us == start);
+
+  // partial batch: after the first frame the receive task waits for further
+  // frames until the maximum latency is over
+  batches = 0;
+  sequence_numbers.clear();
+  start = mock::time_us;
+  mock::on_block = onBlockReceive;
+  transceiver.processBatch();
+  mock::on_block = nullptr;
+  CHECK(batches == 1);
+  CHECK(sequence_numbers == std::vector<uint8_t>({5, 21}));
+  CHECK(mock::time_us - start == LATENCY_MS * 1000);
+
+  // parse failure: counted and released, the other frames are delivered
+  batches = 0;
+  sequence_numbers.clear();
+  const uint8_t truncated[] = {2, 0x41, 0x88};
+  mock::receive(truncated);
+  for (uint8_t seq = 31; seq <= 33; seq++) receive(seq);
+  transceiver.processBatch();
+  CHECK(batches == 1);
+  CHECK(sequence_numbers == std::vector<uint8_t>({31, 32, 33}));
+  transceiver_stats_t stats = transceiver.getStatistics();
+  CHECK(stats.rx_parse_errors == 1);
+  // all slots of the pool are free again
+  for (int j = 0; j < POOL_SIZE; j++) receive(40 + j);
+  CHECK(transceiver.getStatistics().rx_dropped == 0);
+  receive(99);
+  CHECK(transceiver.getStatistics().rx_dropped == 1);
+
+  transceiver.end();
+  printf("ok\n");
+  return 0;
+}
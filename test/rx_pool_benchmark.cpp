@@ -0,0 +1,71 @@
+// Per-frame cost of the RX path with the message buffer and with the frame
+// pool: the ISR part (driver callback up to the hand-off) and the consumer
+// part (read, parse and release) are measured separately.
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "benchmark.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr int FRAMES = 200000;
+static constexpr int BURST = 8;
+
+/// Data frame with short addresses and a payload of the given size
+static void makeFrame(uint8_t* frame, int payload) {
+  uint8_t header[] = {0x41, 0x88, 0, 0x34, 0x12, 0x01, 0x00, 0x02, 0x00};
+  frame[0] = sizeof(header) + payload + 2;
+  memcpy(frame + 1, header, sizeof(header));
+  for (int j = 0; j < payload; j++) frame[1 + sizeof(header) + j] = j;
+}
+
+static void run(const char* name, int poolSize) {
+  uint8_t address[2] = {0x01, 0x00};
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           Address(address));
+  transceiver.setReceiveTask(nullptr);  // frames are read by the benchmark
+  transceiver.setReceiveBufferSize((sizeof(frame_record_t) + 4) * BURST);
+  transceiver.setFramePoolSize(poolSize);
+  CHECK(transceiver.begin());
+
+  // ACKs, sensor reports and full frames
+  const int payloads[] = {2, 12, 12, 110};
+  uint8_t frames[4][MAX_FRAME_LEN];
+  for (int j = 0; j < 4; j++) makeFrame(frames[j], payloads[j]);
+
+  Frame frame;
+  frame_data_t packet;
+  Stopwatch isr, consumer;
+  int parsed = 0;
+  for (int n = 0; n < FRAMES; n += BURST) {
+    isr.start();
+    for (int j = 0; j < BURST; j++) mock::receive(frames[(n + j) % 4]);
+    isr.stop();
+
+    consumer.start();
+    for (int j = 0; j < BURST; j++) {
+      if (poolSize > 0) {
+        frame_data_t* slot = transceiver.receiveFrame(0);
+        parsed += frame.parse(slot->frame, false);
+        transceiver.releaseFrame(slot);
+      } else {
+        transceiver.readFrame(packet, 0);
+        parsed += frame.parse(packet.frame, false);
+      }
+    }
+    consumer.stop();
+  }
+  CHECK(parsed == FRAMES);
+  CHECK(transceiver.getStatistics().rx_dropped == 0);
+  transceiver.end();
+
+  printf("%-15s ISR %6.1f ns %6.0f cycles | consumer %6.1f ns %6.0f cycles\n",
+         name, isr.ns(FRAMES), isr.cycles(FRAMES), consumer.ns(FRAMES),
+         consumer.cycles(FRAMES));
+}
+
+int main() {
+  printf("Per frame cost of %d frames in bursts of %d:\n", FRAMES, BURST);
+  run("message buffer", 0);
+  run("frame pool", BURST);
+  return 0;
+}
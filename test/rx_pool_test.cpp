@@ -0,0 +1,54 @@
+// Hand-off of received frames through the frame pool
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static uint8_t frame[] = {11,   0x41, 0x88, 1, 0x34, 0x12, 0x01,
+                          0x00, 0x02, 0x00, 0xAA, 0,    0};
+
+static void receiveDuringWait() {
+  frame[3]++;
+  mock::receive(frame);
+}
+
+int main() {
+  uint8_t address[2] = {0x01, 0x00};
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           Address(address));
+  transceiver.setReceiveTask(nullptr);  // frames are read by the test
+  transceiver.setFramePoolSize(4);
+  CHECK(transceiver.begin());
+
+  // frames are delivered in order from the slots
+  for (int j = 0; j < 3; j++) {
+    frame[3] = j;
+    mock::receive(frame);
+  }
+  for (int j = 0; j < 3; j++) {
+    frame_data_t* packet = transceiver.receiveFrame(0);
+    CHECK(packet != nullptr);
+    CHECK(packet->frame[0] == 11 && packet->frame[3] == j);
+    transceiver.releaseFrame(packet);
+  }
+
+  // the semaphore is still given for the frames that were read without
+  // waiting: a blocking read must not return before a frame arrived
+  mock::on_block = receiveDuringWait;
+  frame_data_t* packet = transceiver.receiveFrame(100);
+  CHECK(packet != nullptr && packet->frame[3] == frame[3]);
+  transceiver.releaseFrame(packet);
+  mock::on_block = nullptr;
+  CHECK(transceiver.receiveFrame(100) == nullptr);
+  CHECK(transceiver.receiveFrame(0) == nullptr);
+
+  // an exhausted pool drops and counts the frames
+  transceiver.resetStatistics();
+  for (int j = 0; j < 6; j++) mock::receive(frame);
+  CHECK(transceiver.getStatistics().rx_frames == 4);
+  CHECK(transceiver.getStatistics().rx_dropped == 2);
+
+  transceiver.end();
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,106 @@
+// Replays a burst of mixed size frames into the RX message buffer and compares
+// the drops of the compact frame_record_t format with the drops of the former
+// fixed size frame_data_t messages.
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr int BUFFER_SIZE = 4096;
+static constexpr size_t MESSAGE_LENGTH_BYTES = 4;
+
+/// PSDU length (incl. FCS) of the n-th frame: ACKs, sensor reports and full
+/// frames in the ratio 6:3:1
+static uint8_t traceLength(int n) {
+  switch (n % 10) {
+    case 0:
+      return 127;
+    case 1:
+    case 4:
+    case 7:
+      return 24;
+    default:
+      return 5;
+  }
+}
+
+static void makeFrame(uint8_t* frame, int n) {
+  frame[0] = traceLength(n);
+  for (int j = 1; j <= frame[0]; j++) frame[j] = n + j;
+}
+
+/// Number of dropped frames if each frame used a full frame_data_t
+static int fixedSizeDrops(int frames) {
+  size_t used = 0;
+  int drops = 0;
+  for (int n = 0; n < frames; n++) {
+    if (used + sizeof(frame_data_t) + MESSAGE_LENGTH_BYTES > BUFFER_SIZE) {
+      drops++;
+    } else {
+      used += sizeof(frame_data_t) + MESSAGE_LENGTH_BYTES;
+    }
+  }
+  return drops;
+}
+
+int main() {
+  uint8_t address[2] = {0x01, 0x00};
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           Address(address));
+  transceiver.setReceiveTask(nullptr);  // frames are read by the test
+  transceiver.setReceiveBufferSize(BUFFER_SIZE);
+  CHECK(transceiver.begin());
+
+  // burst without reading
+  const int frames = 200;
+  uint8_t frame[MAX_FRAME_LEN];
+  for (int n = 0; n < frames; n++) {
+    makeFrame(frame, n);
+    mock::receive(frame, -40 - n % 50, 1000 + n);
+  }
+  transceiver_stats_t stats = transceiver.getStatistics();
+  int compact_drops = stats.rx_dropped;
+  int fixed_drops = fixedSizeDrops(frames);
+  int compact_stored = frames - compact_drops;
+  int fixed_stored = frames - fixed_drops;
+  printf("%d frames into %d bytes: compact stored %d dropped %d, "
+         "fixed size stored %d dropped %d\n",
+         frames, BUFFER_SIZE, compact_stored, compact_drops, fixed_stored,
+         fixed_drops);
+  CHECK(stats.rx_frames + stats.rx_dropped == frames);
+  CHECK(compact_stored >= 3 * fixed_stored);
+
+  // the stored frames are unchanged and in the order of the trace
+  frame_data_t packet;
+  int stored = 0;
+  int n = 0;
+  while (transceiver.readFrame(packet, 0)) {
+    for (; n < frames; n++) {
+      makeFrame(frame, n);
+      if (memcmp(packet.frame, frame, frame[0] + 1) == 0) break;
+    }
+    CHECK(n < frames);
+    CHECK(packet.frame_info.rssi == -40 - n % 50);
+    CHECK(packet.frame_info.timestamp == 1000 + n);
+    CHECK(packet.frame_info.channel == 11);
+    stored++;
+    n++;
+  }
+  CHECK(stored == compact_stored);
+
+  // only ACKs: each record needs HEADER_SIZE + 6 bytes + the length field
+  const int acks = 400;
+  transceiver.resetStatistics();
+  uint8_t ack[] = {5, 0x02, 0x00, 0x07, 0x00, 0x00};
+  for (int j = 0; j < acks; j++) mock::receive(ack);
+  int ack_stored = acks - transceiver.getStatistics().rx_dropped;
+  printf("ACKs: compact stored %d, fixed size stored %d\n", ack_stored,
+         acks - fixedSizeDrops(acks));
+  CHECK(ack_stored == BUFFER_SIZE / (frame_record_t::HEADER_SIZE + 6 +
+                                     MESSAGE_LENGTH_BYTES));
+  CHECK(ack_stored >= 6 * (acks - fixedSizeDrops(acks)));
+
+  transceiver.end();
+  printf("ok\n");
+  return 0;
+}
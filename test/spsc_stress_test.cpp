@@ -0,0 +1,79 @@
+// A producer and a consumer thread pass a numbered byte sequence through the
+// SPSCRingBuffer with all write and read variants. Run it with
+// -DSANITIZER=thread to let ThreadSanitizer check the memory ordering.
+#include <atomic>
+#include <thread>
+
+#include "RingBuffer.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static constexpr uint32_t TOTAL_BYTES = 300000;
+
+static uint8_t expected(uint32_t pos) { return pos * 31; }
+
+static void produce(SPSCRingBuffer& buffer) {
+  uint8_t tmp[37];
+  uint32_t pos = 0;
+  while (pos < TOTAL_BYTES) {
+    uint32_t len = pos % 37 + 1;
+    if (len > TOTAL_BYTES - pos) len = TOTAL_BYTES - pos;
+    size_t written;
+    if (pos & 1) {
+      for (uint32_t j = 0; j < len; j++) tmp[j] = expected(pos + j);
+      written = buffer.writeArray(tmp, len);
+    } else {
+      uint8_t* data;
+      written = buffer.getWriteSpan(data);
+      if (written > len) written = len;
+      for (size_t j = 0; j < written; j++) data[j] = expected(pos + j);
+      buffer.commit(written);
+    }
+    pos += written;
+    if (written == 0) std::this_thread::yield();
+  }
+}
+
+static bool consume(SPSCRingBuffer& buffer) {
+  uint8_t tmp[41];
+  uint32_t pos = 0;
+  bool ok = true;
+  while (pos < TOTAL_BYTES) {
+    size_t len = 0;
+    if (pos % 3 == 0) {
+      const uint8_t* data;
+      len = buffer.getReadSpan(data);
+      for (size_t j = 0; j < len; j++) ok &= data[j] == expected(pos + j);
+      buffer.consume(len);
+    } else if (pos % 3 == 1) {
+      uint8_t next;
+      if (buffer.peek(next)) {
+        ok &= next == expected(pos);
+        ok &= buffer.read() == expected(pos);
+        len = 1;
+      }
+    } else {
+      len = buffer.readArray(tmp, sizeof(tmp));
+      for (size_t j = 0; j < len; j++) ok &= tmp[j] == expected(pos + j);
+    }
+    pos += len;
+    if (len == 0) std::this_thread::yield();
+  }
+  return ok;
+}
+
+int main() {
+  for (int capacity : {1, 7, 64, 1000}) {
+    SPSCRingBuffer buffer(capacity);
+    bool ok = false;
+    std::thread producer(produce, std::ref(buffer));
+    std::thread consumer([&]() { ok = consume(buffer); });
+    producer.join();
+    consumer.join();
+    printf("capacity %4d: %s\n", capacity, ok ? "ok" : "corrupted");
+    CHECK(ok);
+    CHECK(buffer.isEmpty());
+  }
+  return 0;
+}
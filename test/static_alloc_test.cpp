@@ -0,0 +1,72 @@
+// The static variants of the transceiver and the stream must not use the
+// heap after they have been constructed: operator new is counted while they
+// are started, used and stopped.
+#include <new>
+
+#include "Arduino.h"
+
+#include "ESP32TransceiverStreamIEEE802_15_4.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static int allocations = 0;
+static bool counting = false;
+
+void* operator new(size_t size) {
+  if (counting) allocations++;
+  void* result = malloc(size);
+  if (result == nullptr) throw std::bad_alloc();
+  return result;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+static uint8_t local[2] = {0x01, 0x00};
+static ESP32TransceiverIEEE802_15_4Static<(sizeof(frame_record_t) + 4) * 8, 4,
+                                          1024 * 5, 4>
+    transceiver(channel_t::CHANNEL_11, 0x1234, Address(local));
+static ESP32TransceiverStreamIEEE802_15_4Static<1024 + 116, 8> stream(
+    transceiver);
+
+int main() {
+  uint8_t frame[] = {13,   0x41, 0x88, 1,    0x34, 0x12, 0x01, 0x00,
+                     0x02, 0x00, 0xAA, 0xBB, 0,    0};
+  uint8_t data[20] = {1, 2, 3};
+  uint8_t dest[2] = {0x02, 0x00};
+
+  mock::record_tx = false;
+  counting = true;
+  stream.setArqActive(true, 8);
+  stream.setDestinationAddress(Address(dest));
+  CHECK(stream.begin());
+  for (int j = 0; j < 3; j++) {
+    transceiver.setDestinationAddress(Address(dest));
+    CHECK(transceiver.sendAsync(data, sizeof(data)) != 0);
+    mock::transmitDone();
+  }
+  stream.end();
+
+  // the transceiver alone with the frame pool
+  CHECK(transceiver.begin());
+  for (int j = 0; j < 10; j++) {
+    mock::receive(frame);
+    frame_data_t* packet = transceiver.receiveFrame(0);
+    CHECK(packet != nullptr);
+    transceiver.releaseFrame(packet);
+  }
+  transceiver.end();
+  counting = false;
+
+  // storage that cannot hold a frame is rejected
+  static uint8_t small[sizeof(frame_record_t) + 4];
+  ESP32TransceiverIEEE802_15_4 other(channel_t::CHANNEL_11, 0x1234,
+                                     Address(local));
+  CHECK(!other.setReceiveBufferStorage(small, sizeof(small)));
+  CHECK(!other.setReceiveBufferStorage(small, 0));
+
+  printf("%d heap allocations\n", allocations);
+  CHECK(allocations == 0);
+  return 0;
+}
@@ -0,0 +1,114 @@
+// Statistics counters: the TX results by error code, the parse errors of
+// the receive path and the retransmissions and duplicates of the stream.
+#include "Arduino.h"
+
+#include "ESP32TransceiverStreamIEEE802_15_4.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+/// Provides access to the processing of the receive task
+struct TestTransceiver : ESP32TransceiverIEEE802_15_4 {
+  using ESP32TransceiverIEEE802_15_4::ESP32TransceiverIEEE802_15_4;
+  using ESP32TransceiverIEEE802_15_4::processFrame;
+};
+
+static int tx_attempts = 0;
+
+/// The first attempt of the stream is not acknowledged, the second one is
+static void onBlockRetry() {
+  if (tx_attempts++ == 0) {
+    mock::transmitFailed(ESP_IEEE802154_TX_ERR_NO_ACK);
+  } else {
+    esp_ieee802154_frame_info_t ack{};
+    mock::transmitDone(&ack);
+  }
+}
+
+static uint8_t dataFrame(uint8_t* frame, uint8_t seq) {
+  const uint8_t data[] = {12,   0x41, 0x88, seq,  0x34, 0x12, 0x01,
+                          0x00, 0x02, 0x00, 0xBB, 0,    0};
+  memcpy(frame, data, sizeof(data));
+  return sizeof(data);
+}
+
+int main() {
+  uint8_t local[2] = {0x01, 0x00}, peer[2] = {0x02, 0x00};
+  TestTransceiver transceiver(channel_t::CHANNEL_11, 0x1234, Address(local));
+  transceiver.setReceiveTask(nullptr);
+  transceiver.setDestinationAddress(Address(peer));
+  CHECK(transceiver.begin());
+  uint8_t payload[4] = {1, 2, 3, 4};
+
+  // TX results by error code
+  for (esp_ieee802154_tx_error_t error :
+       {ESP_IEEE802154_TX_ERR_NONE, ESP_IEEE802154_TX_ERR_NO_ACK,
+        ESP_IEEE802154_TX_ERR_NO_ACK, ESP_IEEE802154_TX_ERR_CCA_BUSY,
+        ESP_IEEE802154_TX_ERR_ABORT}) {
+    CHECK(transceiver.sendAsync(payload, sizeof(payload)) != 0);
+    if (error == ESP_IEEE802154_TX_ERR_NONE) {
+      mock::transmitDone();
+    } else {
+      mock::transmitFailed(error);
+    }
+  }
+  transceiver_stats_t stats = transceiver.getStatistics();
+  CHECK(stats.tx_frames == 1);
+  CHECK(stats.tx_bytes == mock::tx_frames[0][0]);
+  CHECK(stats.noAck() == 2);
+  CHECK(stats.ccaFailures() == 1);
+  CHECK(stats.tx_errors[ESP_IEEE802154_TX_ERR_ABORT] == 1);
+  CHECK(stats.tx_errors[ESP_IEEE802154_TX_ERR_NONE] == 0);
+  CHECK(stats.txFailed() == 4);
+
+  // a frame that is too short to be parsed is queued, then counted as a
+  // parse error by the receive task
+  uint8_t frame[MAX_FRAME_LEN];
+  const uint8_t truncated[] = {2, 0x41, 0x88};
+  mock::receive(truncated);
+  dataFrame(frame, 1);
+  mock::receive(frame);
+  for (int j = 0; j < 2; j++) {
+    Frame parsed;
+    frame_data_t* packet = transceiver.receiveFrame(0);
+    CHECK(packet != nullptr);
+    transceiver.processFrame(parsed, packet);
+  }
+  stats = transceiver.getStatistics();
+  CHECK(stats.rx_frames == 2 && stats.rx_parse_errors == 1);
+  CHECK(stats.rx_bytes == 2 + 12);
+
+  transceiver.resetStatistics();
+  stats = transceiver.getStatistics();
+  CHECK(stats.rx_frames == 0 && stats.tx_frames == 0 && stats.txFailed() == 0);
+  transceiver.end();
+
+  // stream: a frame that is not acknowledged is sent again
+  ESP32TransceiverStreamIEEE802_15_4 stream(transceiver);
+  stream.setAckActive(true);
+  stream.setDestinationAddress(Address(peer));
+  CHECK(stream.begin());
+  mock::on_block = onBlockRetry;
+  CHECK(stream.write(payload, sizeof(payload)) == sizeof(payload));
+  mock::on_block = nullptr;
+  stats = transceiver.getStatistics();
+  CHECK(tx_attempts == 2);
+  CHECK(stats.retransmissions == 1);
+  CHECK(stats.noAck() == 1 && stats.tx_frames == 1);
+
+  // stream: a repeated sequence number is ignored as duplicate
+  dataFrame(frame, 7);
+  mock::receive(frame);
+  mock::receive(frame);
+  dataFrame(frame, 8);
+  mock::receive(frame);
+  CHECK(stream.read() == 0xBB);
+  CHECK(stream.read() == -1);
+  CHECK(stream.read() == 0xBB);
+  stats = transceiver.getStatistics();
+  CHECK(stats.duplicates == 1 && stats.rx_frames == 3);
+  stream.end();
+
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,37 @@
+// Host stub of the Arduino core: only what the library uses
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define ARDUINO 100
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t ch) = 0;
+  virtual size_t write(const uint8_t* data, size_t len) {
+    size_t result = 0;
+    while (len--) result += write(*data++);
+    return result;
+  }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+ protected:
+  unsigned long _timeout = 1000;
+};
@@ -0,0 +1,4 @@
+// Host stub of esp_assert.h
+#pragma once
+
+#define ESP_STATIC_ASSERT static_assert
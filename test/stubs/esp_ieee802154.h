@@ -0,0 +1,60 @@
+// Host stub of the ESP-IDF IEEE 802.15.4 driver API
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct {
+  bool pending;
+  bool process;
+  uint8_t channel;
+  int8_t rssi;
+  uint8_t lqi;
+  uint64_t timestamp;  // esp_timer time at which the SFD was received
+} esp_ieee802154_frame_info_t;
+
+typedef enum {
+  ESP_IEEE802154_TX_ERR_NONE,
+  ESP_IEEE802154_TX_ERR_CCA_BUSY,
+  ESP_IEEE802154_TX_ERR_ABORT,
+  ESP_IEEE802154_TX_ERR_NO_ACK,
+  ESP_IEEE802154_TX_ERR_INVALID_ACK,
+  ESP_IEEE802154_TX_ERR_COEXIST,
+  ESP_IEEE802154_TX_ERR_SECURITY,
+} esp_ieee802154_tx_error_t;
+
+typedef enum {
+  ESP_IEEE802154_AUTO_PENDING_DISABLE,
+} esp_ieee802154_pending_mode_t;
+
+esp_err_t esp_ieee802154_enable(void);
+esp_err_t esp_ieee802154_disable(void);
+esp_err_t esp_ieee802154_set_coordinator(bool enable);
+esp_err_t esp_ieee802154_set_promiscuous(bool enable);
+esp_err_t esp_ieee802154_set_rx_when_idle(bool enable);
+esp_err_t esp_ieee802154_set_panid(uint16_t panid);
+esp_err_t esp_ieee802154_set_channel(uint8_t channel);
+esp_err_t esp_ieee802154_set_short_address(uint16_t address);
+esp_err_t esp_ieee802154_set_extended_address(const uint8_t* address);
+esp_err_t esp_ieee802154_set_ack_timeout(uint32_t timeout);
+esp_err_t esp_ieee802154_set_txpower(int8_t power);
+int8_t esp_ieee802154_get_txpower(void);
+esp_err_t esp_ieee802154_receive(void);
+esp_err_t esp_ieee802154_receive_handle_done(const uint8_t* frame);
+esp_err_t esp_ieee802154_transmit(const uint8_t* frame, bool cca);
+esp_err_t esp_ieee802154_energy_detect(uint32_t duration);
+esp_ieee802154_pending_mode_t esp_ieee802154_get_pending_mode(void);
+
+// Implemented by the library, called by the driver (or the test)
+extern "C" {
+void esp_ieee802154_receive_done(uint8_t* frame,
+                                 esp_ieee802154_frame_info_t* frame_info);
+void esp_ieee802154_receive_sfd_done(void);
+void esp_ieee802154_transmit_done(const uint8_t* frame, const uint8_t* ack,
+                                  esp_ieee802154_frame_info_t* ack_frame_info);
+void esp_ieee802154_transmit_failed(const uint8_t* frame,
+                                    esp_ieee802154_tx_error_t error);
+void esp_ieee802154_transmit_sfd_done(uint8_t* frame);
+void esp_ieee802154_energy_detect_done(int8_t power);
+}
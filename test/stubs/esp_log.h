@@ -0,0 +1,12 @@
+// Host stub of esp_log.h: errors and warnings are printed, the rest is dropped
+#pragma once
+#include <stdio.h>
+
+#define ESP_LOG_PRINT(level, tag, ...) \
+  (printf("%s %s: ", level, tag), printf(__VA_ARGS__), puts(""))
+#define ESP_LOGE(tag, ...) ESP_LOG_PRINT("E", tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ESP_LOG_PRINT("W", tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ((void)(tag))
+#define ESP_LOGD(tag, ...) ((void)(tag))
+#define ESP_LOGV(tag, ...) ((void)(tag))
+#define ESP_LOG_BUFFER_HEX(tag, data, len) ((void)(data))
@@ -0,0 +1,53 @@
+// Host stub of FreeRTOS: the tests run in a single thread, so the critical
+// sections are only counted
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;  // as on the ESP32: the stack size is in bytes
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define configTICK_RATE_HZ 1000
+#define tskNO_AFFINITY 0x7fffffff
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(x) (void)(x)
+#define IRAM_ATTR
+
+typedef struct {
+  int depth;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) vPortExitCritical(mux)
+
+typedef struct StaticTask {
+  int unused;
+} StaticTask_t;
+typedef struct StaticStreamBuffer {
+  int unused;
+} StaticStreamBuffer_t;
+typedef StaticStreamBuffer_t StaticMessageBuffer_t;
+typedef struct StaticSemaphore {
+  int unused;
+} StaticSemaphore_t;
+
+typedef struct StreamBufferDef_t* StreamBufferHandle_t;
+typedef StreamBufferHandle_t MessageBufferHandle_t;
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef struct QueueDefinition* SemaphoreHandle_t;
+
+#include "freertos/message_buffer.h"
@@ -0,0 +1,12 @@
+// Host stub of the FreeRTOS message buffer
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+StreamBufferHandle_t xMessageBufferCreate(size_t size);
+StreamBufferHandle_t xMessageBufferCreateStatic(size_t size, uint8_t* storage,
+                                                StaticMessageBuffer_t* buffer);
+void vMessageBufferDelete(StreamBufferHandle_t buffer);
+size_t xMessageBufferSendFromISR(StreamBufferHandle_t buffer, const void* data,
+                                 size_t len, BaseType_t* woken);
+size_t xMessageBufferReceive(StreamBufferHandle_t buffer, void* data,
+                             size_t len, TickType_t wait);
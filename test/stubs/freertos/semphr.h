@@ -0,0 +1,11 @@
+// Host stub of the FreeRTOS semaphores
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer);
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore,
+                                 BaseType_t* woken);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
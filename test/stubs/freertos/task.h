@@ -0,0 +1,27 @@
+// Host stub of the FreeRTOS tasks: tasks are not started, the tests call the
+// processing functions directly
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name,
+                                   uint32_t stack_size, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function,
+                                           const char* name,
+                                           uint32_t stack_size,
+                                           void* parameter,
+                                           UBaseType_t priority,
+                                           StackType_t* stack,
+                                           StaticTask_t* task,
+                                           BaseType_t core);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char* name,
+                               uint32_t stack_size, void* parameter,
+                               UBaseType_t priority, StackType_t* stack,
+                               StaticTask_t* task);
+void vTaskDelete(TaskHandle_t handle);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle);
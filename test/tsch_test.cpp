@@ -0,0 +1,177 @@
+// TSCH on the virtual clock of the mocks: the schedules of many node pairs
+// are simulated for collisions, then the scheduler runs the slotframe of a
+// coordinator and a node synchronizes to its beacons.
+#include <map>
+
+#include "TschScheduler.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+/// Provides access to the reception and the epoch
+struct TestScheduler : TschScheduler {
+  using TschScheduler::epoch;
+  using TschScheduler::receive;
+  using TschScheduler::TschScheduler;
+};
+
+struct sim_result_t {
+  int sent = 0;
+  int delivered = 0;
+  int collisions = 0;
+};
+
+/// Pair k sends from node 2k to node 2k+1 in a dedicated cell
+static sim_result_t simulate(int pairs, uint16_t length, bool hopping,
+                             uint64_t slots) {
+  std::vector<TschSchedule> tx(pairs), rx(pairs);
+  for (int k = 0; k < pairs; k++) {
+    uint16_t slot = k % length;
+    uint8_t offset = hopping ? k / length : 0;
+    for (TschSchedule* schedule : {&tx[k], &rx[k]}) {
+      schedule->setSlotframeLength(length);
+      if (!hopping) schedule->setHoppingSequence({channel_t::CHANNEL_11});
+    }
+    uint8_t to[2] = {(uint8_t)(2 * k + 1), 0};
+    uint8_t from[2] = {(uint8_t)(2 * k), 0};
+    CHECK(tx[k].addCell(slot, offset, tsch_cell_type_t::TX, Address(to)));
+    CHECK(rx[k].addCell(slot, offset, tsch_cell_type_t::RX, Address(from)));
+  }
+  sim_result_t result;
+  for (uint64_t asn = 0; asn < slots; asn++) {
+    std::map<int, std::vector<int>> on_air;  // channel -> senders
+    for (int k = 0; k < pairs; k++) {
+      const tsch_cell_t* cell = tx[k].cell(asn);
+      if (cell == nullptr) continue;
+      on_air[(int)tx[k].channel(asn, cell->channel_offset)].push_back(k);
+      result.sent++;
+    }
+    for (auto& [channel, senders] : on_air) {
+      if (senders.size() > 1) {
+        result.collisions += senders.size();
+        continue;
+      }
+      // the receiver must listen on the same channel
+      const tsch_cell_t* cell = rx[senders[0]].cell(asn);
+      if (cell != nullptr &&
+          (int)rx[senders[0]].channel(asn, cell->channel_offset) == channel) {
+        result.delivered++;
+      }
+    }
+  }
+  return result;
+}
+
+/// Beacon of the coordinator as received by the node
+static Frame beaconFrame(const uint8_t* source, uint8_t* payload,
+                         uint64_t asn) {
+  Frame frame;
+  uint8_t magic[4] = {'T', 'S', 'C', 'H'};
+  memcpy(payload, magic, 4);
+  for (int j = 0; j < 5; j++) payload[4 + j] = (asn >> (8 * j)) & 0xFF;
+  frame.srcAddrLen = 2;
+  memcpy(frame.srcAddress, source, 2);
+  frame.destAddrLen = 2;
+  frame.fcf.panIdCompression = 1;
+  frame.payload = payload;
+  frame.payloadLen = 9;
+  return frame;
+}
+
+int main() {
+  // 8 timeslots of 10 ms: with 16 channels up to 128 pairs without collision
+  const uint16_t length = 8;
+  const uint64_t slots = length * 16 * 10;
+  const double seconds = slots * 0.010;
+  for (int pairs : {1, 8, 32, 128}) {
+    sim_result_t hopping = simulate(pairs, length, true, slots);
+    sim_result_t single = simulate(pairs, length, false, slots);
+    printf("%3d pairs: hopping %6.1f frames/s (%d collisions), single "
+           "channel %6.1f frames/s (%d collisions)\n",
+           pairs, hopping.delivered / seconds, hopping.collisions,
+           single.delivered / seconds, single.collisions);
+    CHECK(hopping.collisions == 0 && hopping.delivered == hopping.sent);
+  }
+
+  // coordinator: beacon in the shared cell, data in the TX cell
+  uint8_t local[2] = {1, 0}, peer_bytes[2] = {2, 0};
+  Address peer(peer_bytes);
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           Address(local));
+  transceiver.setReceiveTask(nullptr);
+  TschSchedule schedule(4);
+  CHECK(schedule.addCell(0, 0, tsch_cell_type_t::SHARED));
+  CHECK(schedule.addCell(1, 5, tsch_cell_type_t::TX, peer));
+  CHECK(schedule.addCell(2, 5, tsch_cell_type_t::RX, peer));
+  CHECK(!schedule.addCell(2, 1, tsch_cell_type_t::RX, peer));
+  TestScheduler coordinator(transceiver, schedule);
+  CHECK(transceiver.begin());
+  mock::time_us = 1000000;
+  CHECK(coordinator.begin() && coordinator.isSynchronized());
+
+  // the destination of the transceiver is not changed by the scheduler
+  uint8_t other[2] = {7, 0};
+  transceiver.setDestinationAddress(Address(other));
+  uint8_t data[3] = {1, 2, 3};
+  std::vector<int> channels;
+  size_t sent = mock::tx_frames.size();
+  for (int slot = 0; slot < 8; slot++) {
+    size_t before = mock::tx_frames.size();
+    mock::advance(9999);
+    channels.push_back(mock::channel);
+    if (slot == 0) CHECK(coordinator.send(peer, data, 3));
+    mock::advance(1);
+    if (mock::tx_frames.size() > before) mock::transmitDone();
+  }
+  // beacons in slot 0 and 4, the data in slot 1
+  CHECK(mock::tx_frames.size() - sent == 3);
+  CHECK(channels[1] == (int)schedule.channel(1, 5));
+  CHECK(channels[2] == (int)schedule.channel(2, 5));
+  FrameView beacon(mock::tx_frames[sent].data());
+  CHECK(beacon.destAddress()[0] == 0xFF && beacon.payloadLen() == 9);
+  FrameView frame(mock::tx_frames[sent + 1].data());
+  CHECK(frame.destAddrLen() == 2 && frame.destAddress()[0] == 2);
+  CHECK(frame.payloadLen() == 3 && frame.payload()[2] == 3);
+  coordinator.end();
+  CHECK(transceiver.sendAsync(data, 3) != 0);
+  CHECK(FrameView(mock::tx_frames.back().data()).destAddress()[0] == 7);
+  mock::transmitDone();
+  transceiver.end();
+
+  // node: synchronizes with a beacon and corrects the drift
+  uint8_t source[2] = {9, 0};
+  ESP32TransceiverIEEE802_15_4 node_transceiver(channel_t::CHANNEL_11, 0x1234,
+                                                Address(peer_bytes));
+  node_transceiver.setReceiveTask(nullptr);
+  TestScheduler node(node_transceiver, schedule);
+  node.setTimeSource(Address(source));
+  CHECK(node_transceiver.begin());
+  CHECK(node.begin() && !node.isSynchronized());
+  CHECK(mock::channel == 16);  // first channel of the hopping sequence
+
+  // beacon of ASN 40 sent at 5 s + TX offset: the timestamp is the SFD
+  const uint64_t sfd_delay = SHR_LEN * BYTE_TIME_US;
+  const uint64_t tx_offset = 2120;
+  uint8_t payload[9];
+  Frame frame40 = beaconFrame(source, payload, 40);
+  esp_ieee802154_frame_info_t info{};
+  info.timestamp = 5000000 + tx_offset + sfd_delay;
+  mock::time_us = info.timestamp + 100;
+  node.receive(frame40, info);
+  CHECK(node.isSynchronized());
+  CHECK(node.getAsn() == 40 && node.epoch() == 5000000 - 40 * 10000);
+
+  // later frames of the time source correct the drift
+  payload[0] = 'X';  // no beacon
+  info.timestamp = 5000000 + 3 * 10000 + tx_offset + sfd_delay + 35;
+  node.receive(frame40, info);
+  CHECK(node.getLastDriftUs() == 35);
+  info.timestamp = 5000000 + 7 * 10000 + tx_offset + sfd_delay - 20;
+  node.receive(frame40, info);
+  CHECK(node.getLastDriftUs() == -55);
+  node.end();
+  node_transceiver.end();
+
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,122 @@
+// Closed loop TX power control: the power of each frame follows the ACK RSSI
+// of its destination within the power range, the margin follows the missing
+// ACKs and the ACK LQI, broadcast frames use the base power and the least
+// recently used neighbor is replaced.
+#include "ESP32TransceiverIEEE802_15_4.h"
+#include "TxPowerController.h"
+#include "mocks.h"
+
+using namespace ieee802154;
+
+static ESP32TransceiverIEEE802_15_4* p_transceiver = nullptr;
+
+static Address shortAddress(uint8_t id) {
+  uint8_t address[2] = {id, 0x00};
+  return Address(address);
+}
+
+/// Queues a frame to the destination and returns the power of the radio
+static int8_t send(Address destination) {
+  uint8_t payload[4] = {1, 2, 3, 4};
+  p_transceiver->setDestinationAddress(destination);
+  size_t frames = mock::tx_powers.size();
+  CHECK(p_transceiver->sendAsync(payload, sizeof(payload)) != 0);
+  CHECK(mock::tx_powers.size() == frames + 1);
+  return mock::tx_powers.back();
+}
+
+/// Sends a frame that is acknowledged with the RSSI and the LQI
+static int8_t sendAcked(Address destination, int8_t rssi, uint8_t lqi = 255) {
+  int8_t power = send(destination);
+  esp_ieee802154_frame_info_t ack{};
+  ack.rssi = rssi;
+  ack.lqi = lqi;
+  mock::transmitDone(&ack);
+  return power;
+}
+
+/// Sends a frame that fails with the error
+static int8_t sendFailed(Address destination, esp_ieee802154_tx_error_t error) {
+  int8_t power = send(destination);
+  mock::transmitFailed(error);
+  return power;
+}
+
+static bool isInTable(TxPowerController& controller, Address address) {
+  for (int j = 0; j < TxPowerController::MAX_NEIGHBORS; j++) {
+    tx_power_neighbor_t neighbor = controller.getNeighbor(j);
+    if (neighbor.key_len == address.length() &&
+        neighbor.key == address.key()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main() {
+  ESP32TransceiverIEEE802_15_4 transceiver(channel_t::CHANNEL_11, 0x1234,
+                                           shortAddress(0x01));
+  p_transceiver = &transceiver;
+  transceiver.setReceiveTask(nullptr);
+  transceiver.getFrameControlField().ackRequest = 1;
+  TxPowerController controller;
+  controller.setPowerRange(-15, 20);
+  controller.setTargetRssi(-85);
+  controller.setAckTxPower(20);
+  controller.setStepDb(3);
+  controller.setDecreaseAfter(8);
+  controller.setMinLqi(100);
+  transceiver.setTxPowerController(&controller);
+  CHECK(transceiver.begin());
+  CHECK(transceiver.setTxPower(0));
+
+  // a new neighbor starts with the maximum power, then the power is
+  // 20 - ACK RSSI - 85 limited to the power range
+  Address near = shortAddress(0x10), far = shortAddress(0x11);
+  CHECK(sendAcked(near, -40) == 20);
+  CHECK(controller.getPower(near) == -15);
+  CHECK(sendAcked(near, -40) == -15);
+  CHECK(sendAcked(far, -100) == 20);
+  CHECK(controller.getPower(far) == 20);
+
+  // a missing ACK and an ACK below the minimum LQI add a step to the margin
+  Address mid = shortAddress(0x12);
+  CHECK(sendAcked(mid, -70) == 20);
+  CHECK(controller.getPower(mid) == 5);
+  CHECK(sendFailed(mid, ESP_IEEE802154_TX_ERR_NO_ACK) == 5);
+  CHECK(controller.getPower(mid) == 8);
+  // other errors do not indicate an insufficient power
+  CHECK(sendFailed(mid, ESP_IEEE802154_TX_ERR_CCA_BUSY) == 8);
+  CHECK(controller.getPower(mid) == 8);
+  CHECK(sendAcked(mid, -70, 50) == 8);
+  CHECK(controller.getPower(mid) == 11);
+  // decrease_after good ACKs remove a step
+  for (int j = 0; j < 7; j++) sendAcked(mid, -70);
+  CHECK(controller.getPower(mid) == 11);
+  CHECK(sendAcked(mid, -70) == 11);
+  CHECK(controller.getPower(mid) == 8);
+  CHECK(controller.getNeighbor(2).margin == 3);
+
+  // broadcast frames are sent with the base power and are not tracked
+  CHECK(sendAcked(BROADCAST_ADDRESS, -40) == 0);
+  CHECK(!isInTable(controller, BROADCAST_ADDRESS));
+  CHECK(sendAcked(near, -40) == -15);
+  CHECK(sendAcked(BROADCAST_ADDRESS, -40) == 0);
+
+  // the least recently used neighbor is replaced
+  controller.clear();
+  for (int id = 1; id <= TxPowerController::MAX_NEIGHBORS; id++) {
+    sendAcked(shortAddress(0x20 + id), -40);
+  }
+  CHECK(sendAcked(shortAddress(0x21), -40) == -15);
+  Address added = shortAddress(0x20 + TxPowerController::MAX_NEIGHBORS + 1);
+  CHECK(sendAcked(added, -40) == 20);
+  CHECK(isInTable(controller, added));
+  CHECK(!isInTable(controller, shortAddress(0x22)));
+  CHECK(controller.getPower(shortAddress(0x22)) == 20);
+  CHECK(controller.getPower(shortAddress(0x21)) == -15);
+  CHECK(controller.getPower(shortAddress(0x23)) == -15);
+
+  printf("ok\n");
+  return 0;
+}